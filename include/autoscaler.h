@@ -0,0 +1,50 @@
+#ifndef AUTOSCALER_H
+#define AUTOSCALER_H
+
+#include "config.h"
+#include "miner.h"
+#include "stats.h"
+#include <string>
+#include <cstdint>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+// Moves the worker count with the load on the host, one worker per step
+// every autoscale_interval seconds, between autoscale_min and max_workers.
+// A worker retires when anything else wants the CPUs: CPU pressure (PSI)
+// above autoscale_pressure, cgroup quota throttling, or the miner getting
+// less than 80% of the CPU time its workers ask for while not waiting on the
+// pool. One is added while a whole CPU of the miner's own limit (affinity,
+// cpuset, quota) goes unused and none of those hold. The step after a change
+// is skipped, so the sampler sees the new count before the next decision.
+class Autoscaler {
+private:
+    const Config& config;
+    Miner& miner;
+    const SystemStats& system;
+    bool running = false;
+    bool settling = false;
+    uint64_t wait_mark = 0;     // worker connect/job/submit/paused ns at the last step
+    uint64_t total_mark = 0;    // all worker phase ns at the last step
+    std::mutex mutex;
+    std::condition_variable cv;
+    std::thread scaler_thread;
+
+    void run();
+    void step();
+    // Share of worker time since the last call spent waiting on the pool
+    // or parked, when no CPU is wanted
+    double wait_share();
+    // Empty when nothing competes with the workers
+    std::string contention(const CpuSample& cpu, int workers, double waiting) const;
+
+public:
+    Autoscaler(const Config& cfg, Miner& miner, const SystemStats& system);
+    ~Autoscaler();
+
+    void start();
+    void stop();
+};
+
+#endif
@@ -3,7 +3,8 @@
 
 class Benchmark {
 public:
-    void run(int threads);
+    // perf: also report hardware counters (cycles/hash, IPC) if available
+    void run(int threads, bool perf = false);
 };
 
 #endif
\ No newline at end of file
@@ -7,22 +7,73 @@
 #include <random>
 #include <sstream>
 #include <iomanip>
+#include <vector>
+#include <algorithm>
+#include "cpu_limits.h"
 
 #define VERSION "4.3.0"
 #define SEPARATOR ","
+#define MAX_THREADS 1024
+#define STATS_THREAD_DETAIL 64  // above this many workers 's' skips per-thread lines
+
+struct PoolConfig {
+    std::string address;
+    int port = 0;
+    int weight = 1;
+};
 
 class Config {
 public:
     std::string username;
     std::string mining_key = "None";
     std::string rig_identifier = "Auto";
-    std::string start_diff = "NET";
+    std::string start_diff = "NET";  // LOW, MEDIUM, NET, AUTO (per-worker controller)
     std::string pool_address = "";  // Custom pool
     int pool_port = 0;
+    std::vector<PoolConfig> pools;   // Multi-pool sharding
+    std::string pool_balance = "weighted";  // weighted, adaptive
+    std::string pool_cache = "pool_cache.json";  // empty = disabled
+    int pool_cache_ttl = 3600;
     int threads = 0;
-    int intensity = 95;
+    int max_workers = 0;             // ceiling for runtime scaling, 0 = usable CPUs
+    int retire_grace = 10;           // seconds a retiring worker may spend finishing its job
+    int pause_refresh = 60;          // seconds parked before a worker reconnects for a new job, 0 = never
+    bool autoscale = false;          // follow host load between autoscale_min and max_workers
+    int autoscale_min = 1;
+    int autoscale_interval = 10;     // seconds between scaling steps
+    double autoscale_pressure = 10;  // PSI cpu "some" percent that makes a worker retire
+    int intensity = 95;              // CPU duty cycle per thread, percent
+    std::string affinity = "scatter";  // scatter, compact, physical, none
+    std::string sysfs_root = "";     // prefix for /sys and /proc topology and cgroup reads (testing)
+    std::string kernel = "auto";     // digest compare: auto, scalar, avx2, avx512, neon
+    std::string efficiency_diff = "";     // E-core start difficulty, empty = one tier lower
+    std::string efficiency_kernel = "auto";
+    double efficiency_weight = 0;    // E-core work share vs a P-core, 0 = from cpu_capacity
+    double max_hashrate = 0;         // H/s cap for the whole process, 0 = off
+    double max_hashrate_thread = 0;  // H/s cap per thread, 0 = off
     int soc_timeout = 15;
     int report_interval = 300;
+    int sample_interval = 2;         // seconds between /proc CPU samples
+    std::string http_host = "127.0.0.1";  // metrics listener address
+    int http_port = 0;               // /metrics and /api/summary, 0 = off
+    bool http_control = false;       // accept POST /api/workers on the metrics listener
+    std::string statsd_host = "";    // UDP push every report_interval, empty = off
+    int statsd_port = 8125;
+    std::string statsd_prefix = "duino";
+    std::string statsd_format = "dogstatsd";  // dogstatsd (tags) or statsd
+    int statsd_mtu = 1432;           // max datagram payload
+    std::string shm_name = "";       // POSIX shm stats segment, empty = off
+    int shm_interval = 250;          // ms between segment updates
+    bool perf_counters = false;      // per-thread perf_event_open counters
+    std::string journal_file = "";   // binary job/share journal, empty = off
+    int journal_max_mb = 64;         // rotate at this size
+    int journal_keep = 3;            // rotated files kept (file.1 .. file.N)
+    int journal_fsync = 5;           // seconds between fsyncs
+    std::string log_mode = "full";   // full or summary (one share line per log_interval)
+    int log_interval = 10;           // seconds between summary lines
+    double log_rate = 0;             // lines/s per job/share/diff class, 0 = unlimited
+    std::string trace_file = "";     // Chrome trace output, empty = off
+    int trace_events = 16384;        // ring size per thread
     int retry_delay = 5;
     int max_retries = 3;
     std::string miner_id;
@@ -44,18 +95,55 @@ public:
 
     void validate() {
         if (threads <= 0) {
-            threads = std::thread::hardware_concurrency();
+            threads = CpuLimits::default_threads(sysfs_root);
+        }
+        if (threads > MAX_THREADS) {
+            threads = MAX_THREADS;
         }
-        if (threads > 128) {
-            threads = 128;
+        if (max_workers <= 0) {
+            max_workers = CpuLimits::default_threads(sysfs_root);
         }
+        max_workers = std::min(std::max(max_workers, threads), MAX_THREADS);
+        if (retire_grace < 0) retire_grace = 0;
+        if (pause_refresh < 0) pause_refresh = 0;
+        autoscale_min = std::min(std::max(autoscale_min, 1), max_workers);
+        if (autoscale_pressure <= 0) autoscale_pressure = 10;
         if (intensity < 1) intensity = 1;
         if (intensity > 100) intensity = 100;
 
-        if (start_diff != "LOW" && start_diff != "MEDIUM" && start_diff != "NET") {
+        if (start_diff != "LOW" && start_diff != "MEDIUM" && start_diff != "NET" &&
+            start_diff != "AUTO") {
             start_diff = "NET";
         }
 
+        if (pools.empty() && !pool_address.empty()) {
+            pools.push_back({pool_address, pool_port, 1});
+        }
+        if (affinity != "scatter" && affinity != "compact" && affinity != "physical" &&
+            affinity != "none") {
+            affinity = "scatter";
+        }
+        if (!efficiency_diff.empty() && efficiency_diff != "LOW" && efficiency_diff != "MEDIUM" &&
+            efficiency_diff != "NET" && efficiency_diff != "AUTO") {
+            efficiency_diff = "";
+        }
+        if (efficiency_weight < 0) efficiency_weight = 0;
+        if (pool_balance != "weighted" && pool_balance != "adaptive") {
+            pool_balance = "weighted";
+        }
+        if (statsd_format != "dogstatsd" && statsd_format != "statsd") {
+            statsd_format = "dogstatsd";
+        }
+        if (log_mode != "full" && log_mode != "summary") {
+            log_mode = "full";
+        }
+        if (log_interval < 1) log_interval = 1;
+        if (sample_interval < 1) sample_interval = 1;
+        // Each scaling step needs a CPU sample taken after the last one
+        autoscale_interval = std::max(autoscale_interval, sample_interval);
+        if (journal_max_mb < 1) journal_max_mb = 1;
+        if (log_rate < 0) log_rate = 0;
+
         if (rig_identifier == "Auto") {
             rig_identifier = generate_rig_id();
         }
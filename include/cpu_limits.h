@@ -0,0 +1,41 @@
+#ifndef CPU_LIMITS_H
+#define CPU_LIMITS_H
+
+#include <string>
+#include <vector>
+
+// What the process may really run on. A container limited by a cgroup CPU
+// quota (v2 cpu.max, v1 cpu.cfs_quota_us) or cpuset, or a miner started under
+// taskset, still sees every host CPU in sysfs and hardware_concurrency();
+// sizing workers from those oversubscribes the quota and the kernel throttles
+// them for the rest of every period.
+//
+// Every path is prefixed with root like Topology's. A fake root stands in for
+// the whole machine, so the process affinity mask is only applied without one.
+struct CpuLimits {
+    std::vector<int> allowed;       // affinity mask and cpuset, empty = no limit known
+    double quota = 0.0;             // in CPUs, 0 = no quota
+    int cgroup_version = 0;         // 0 = no cgroup found
+    std::string cpu_dir;            // cgroup of the cpu controller, holds cpu.stat
+
+    bool load(const std::string& root = "");
+
+    // floor(quota), no more than the allowed CPUs, at least 1
+    int usable_cpus() const;
+    bool allows(int cpu) const;
+    std::string describe() const;
+
+    // Worker count when none is configured
+    static int default_threads(const std::string& root = "");
+};
+
+// Cumulative cpu.stat counters of the miner's cgroup
+struct CpuThrottle {
+    unsigned long long periods = 0;
+    unsigned long long throttled = 0;       // periods that hit the quota
+    double throttled_seconds = 0.0;
+};
+
+bool parse_cpu_stat(const char* text, CpuThrottle& throttle);
+
+#endif
@@ -0,0 +1,54 @@
+#ifndef DIFFICULTY_H
+#define DIFFICULTY_H
+
+#include <string>
+
+enum DiffTier {
+    DIFF_LOW = 0,
+    DIFF_MEDIUM = 1,
+    DIFF_NET = 2
+};
+
+#define DIFF_TIER_COUNT 3
+
+// Tuning for start_diff: AUTO
+#define DIFF_MIN_USEFUL 0.95     // hashing share of a job cycle before stepping up
+#define DIFF_MAX_SOLVE 120.0     // seconds per share before stepping down
+#define DIFF_MIN_JOBS 8          // jobs between decisions
+#define DIFF_BACKOFF_JOBS 64     // no step up for this long after a step down
+
+// Per-worker difficulty tier selection. Each worker owns one instance, so
+// no synchronisation is needed; decisions are published through MiningStats.
+class DifficultyController {
+private:
+    bool adaptive;
+    int tier;
+    int jobs_since_change = 0;
+    int up_blocked = 0;
+    bool too_easy = false;
+    double ewma_solve = 0.0;
+    double ewma_useful = 1.0;
+    double ewma_rtt = 0.0;
+    std::string last_reason;
+
+    void change(int delta, const std::string& reason);
+
+public:
+    explicit DifficultyController(const std::string& start_diff);
+
+    // Returns true when the tier changed
+    bool record(double solve_seconds, int job_rtt_ms, int submit_rtt_ms,
+                bool accepted, const std::string& reject_reason);
+
+    int get_tier() const { return tier; }
+    const char* get_tier_name() const { return tier_name(tier); }
+    bool is_adaptive() const { return adaptive; }
+    double get_solve_time() const { return ewma_solve; }
+    double get_useful() const { return ewma_useful; }
+    double get_rtt() const { return ewma_rtt; }
+    const std::string& get_reason() const { return last_reason; }
+
+    static const char* tier_name(int tier);
+};
+
+#endif
@@ -17,8 +17,15 @@
 
 class Hasher {
 public:
+    typedef bool (*CompareKernel)(const uint8_t hash1[20], const uint8_t hash2[20]);
+    
     static void ducos1_hash(const std::string& input, uint8_t output[20]);
+    static const char* kernel_name();
     static bool ducos1_compare(const uint8_t hash1[20], const uint8_t hash2[20]);
+    static bool ducos1_compare_scalar(const uint8_t hash1[20], const uint8_t hash2[20]);
+    // Digest compare by name: auto (best the CPU supports), scalar, avx2,
+    // avx512, neon. nullptr when not built in or not supported by this CPU.
+    static CompareKernel compare_kernel(const std::string& name);
     static std::string bytes_to_hex(const uint8_t* bytes, size_t len);
     static void hex_to_bytes(const std::string& hex, uint8_t* bytes);
     
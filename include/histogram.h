@@ -0,0 +1,61 @@
+#ifndef HISTOGRAM_H
+#define HISTOGRAM_H
+
+#include <atomic>
+#include <cstdint>
+
+#define HIST_SUB_BITS 3
+#define HIST_SUB (1 << HIST_SUB_BITS)
+#define HIST_BUCKETS 256
+
+struct HistogramSummary {
+    uint64_t count;
+    double mean_ms;
+    double p50_ms;
+    double p90_ms;
+    double p99_ms;
+    double max_ms;
+};
+
+// Fixed-bucket log-linear latency histogram (HDR style, 8 sub-buckets per
+// power of two, ~12% resolution) over microseconds, up to ~2.4 hours.
+// record() is one relaxed atomic add, cheap enough for every share;
+// summaries can be taken concurrently from any thread.
+class LatencyHistogram {
+private:
+    std::atomic<uint32_t> buckets[HIST_BUCKETS] = {};
+    std::atomic<uint64_t> total_us{0};
+    std::atomic<uint64_t> max_us{0};
+
+    static int bucket_of(uint64_t us) {
+        if (us < HIST_SUB) return (int)us;
+        int exp = 63 - __builtin_clzll(us);
+        int mantissa = (us >> (exp - HIST_SUB_BITS)) & (HIST_SUB - 1);
+        int idx = (exp - HIST_SUB_BITS + 1) * HIST_SUB + mantissa;
+        return idx < HIST_BUCKETS ? idx : HIST_BUCKETS - 1;
+    }
+
+    static HistogramSummary summarize(const uint32_t* counts, uint64_t total, uint64_t max);
+
+public:
+    void record(uint64_t us) {
+        buckets[bucket_of(us)].fetch_add(1, std::memory_order_relaxed);
+        total_us.fetch_add(us, std::memory_order_relaxed);
+        uint64_t prev = max_us.load(std::memory_order_relaxed);
+        while (us > prev &&
+               !max_us.compare_exchange_weak(prev, us, std::memory_order_relaxed)) {}
+    }
+
+    void record_ms(double ms) { record(ms > 0 ? (uint64_t)(ms * 1000.0) : 0); }
+
+    HistogramSummary summary() const;
+
+    // Summary of what was recorded since the last take(), then starts over.
+    // A record() racing with it may be split across the two windows.
+    HistogramSummary take();
+
+    // Lower bound in microseconds of bucket idx
+    static uint64_t bucket_floor(int idx);
+};
+
+#endif
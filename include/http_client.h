@@ -6,11 +6,15 @@
 class HttpClient {
 public:
     static std::string get(const std::string& url);
-    
+
+    // Drop idle keep-alive connections
+    static void close_all();
+
 private:
-    static bool parse_url(const std::string& url, std::string& host, 
+    static bool parse_url(const std::string& url, std::string& host,
                          std::string& path, int& port, bool& use_ssl);
-    static std::string https_get(const std::string& host, const std::string& path, int port);
+    static std::string https_get(const std::string& host, const std::string& path,
+                                 int port, bool use_ssl, std::string& location);
 };
 
-#endif
\ No newline at end of file
+#endif
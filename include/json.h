@@ -10,6 +10,9 @@ public:
     static std::string get_value(const std::string& json, const std::string& key);
     static bool get_bool(const std::string& json, const std::string& key);
     static int get_int(const std::string& json, const std::string& key);
+    
+    // Quoted and escaped JSON string literal
+    static std::string quote(const std::string& value);
 };
 
 #endif
\ No newline at end of file
@@ -2,6 +2,9 @@
 #define LOGGER_H
 
 #include <string>
+#include "histogram.h"
+#include <vector>
+#include <utility>
 
 class Logger {
 public:
@@ -9,6 +12,23 @@ public:
     static void disable();
     static bool is_enabled();
     
+    // Hand formatting and stdout writes to a background thread; until
+    // start_writer() and after stop_writer() every call writes directly
+    static void start_writer();
+    static void stop_writer();
+    static unsigned long long dropped();
+    
+    // Everything this thread logs between begin_report() and end_report()
+    // is collected and written as one block, so a long report ('s') neither
+    // fills the queue nor gets interleaved with share lines
+    static void begin_report();
+    static void end_report();
+    
+    // summary folds accepted/rejected shares into one line per interval;
+    // lines_per_second caps each message class (0 = unlimited). Errors and
+    // BLOCK always pass.
+    static void configure(bool summary, int interval_seconds, double lines_per_second);
+    
     static void info(const std::string& message);
     static void success(const std::string& message);
     static void warning(const std::string& message);
@@ -25,6 +45,39 @@ public:
     static void net_block(int thread_id, unsigned long blocks);
     static void net_error(const std::string& message);
     static void net_disconnected(const std::string& reason);
+    static void pool_update(const std::string& pool, int port, int workers,
+                           double hashrate, unsigned long accepted,
+                           unsigned long rejected, int rtt);
+    
+    // Difficulty controller
+    static void diff_change(int thread_id, const std::string& from,
+                           const std::string& to, const std::string& reason);
+    static void diff_summary(int low, int medium, int net);
+    static void thread_stats(int thread_id, double hashrate, const std::string& tier,
+                            int solve_ms, int useful_permille, unsigned long jobs,
+                            double hashing_seconds, double waiting_seconds);
+    static void phase_breakdown(const std::vector<std::pair<std::string, double>>& seconds);
+    static void perf_stats(double cycles_per_hash, double ipc,
+                          double branch_misses_per_hash, double l1d_misses_per_hash);
+    static void latency_stats(const HistogramSummary& job_rtt,
+                             const HistogramSummary& solve_time,
+                             const HistogramSummary& submit_rtt);
+    // Socket traffic; thread_id < 0 prints the process totals
+    static void io_stats(int thread_id, unsigned long long bytes_sent,
+                        unsigned long long bytes_received, unsigned long long messages_sent,
+                        unsigned long long messages_received, unsigned long long syscalls,
+                        unsigned long long connects);
+    static void bytes_per_share(const std::vector<std::pair<std::string, double>>& tiers);
+    // Usage in percent of one CPU; pressure < 0 when the kernel has no PSI,
+    // throttled (percent of cgroup quota periods) < 0 without a quota
+    static void cpu_usage(double system_usage, double pressure, double process_usage,
+                         double hashes_per_cpu_second, double throttled);
+    static void thread_cpu(double usage, double cpu_seconds, double hashes_per_cpu_second);
+    static void node_stats(int node, int threads, double hashrate,
+                           unsigned long accepted, unsigned long rejected);
+    static void class_stats(const std::string& name, int threads, double hashrate,
+                           double weight, const std::string& difficulty,
+                           const std::string& kernel);
     
     // Mining stats
     static void share(int thread_id, const std::string& result_type, 
@@ -37,12 +90,13 @@ public:
                      unsigned long accepted, unsigned long rejected);
     
     // Speed update - prints new line instead of overwriting
-    static void speed_update(int threads, double total_hashrate,
-                            unsigned long accepted, unsigned long rejected);
+    static void speed_update(double hashrate_10s, double hashrate_60s,
+                            double hashrate_15m, double max_hashrate);
     
     // Helper functions
     static std::string format_hashrate(double hashrate);
     static std::string format_difficulty(int difficulty);
+    static std::string format_bytes(unsigned long long bytes);
     static std::string get_colored_box(const std::string& type);
     
     static void print_versions(const std::string& app_version, const std::string& libuv_version);
@@ -0,0 +1,44 @@
+#ifndef METRICS_SERVER_H
+#define METRICS_SERVER_H
+
+#include "config.h"
+#include "miner.h"
+#include "stats.h"
+#include <string>
+#include <thread>
+#include <atomic>
+
+// Minimal HTTP listener for monitoring:
+//   GET /metrics      Prometheus text exposition
+//   GET /api/summary  JSON summary
+//   GET /api/workers  running and maximum worker count
+//   POST /api/workers?count=N or ?delta=+-N
+//                     changes the worker count, only with http_control
+// Requests are served one at a time on a background thread from
+// Miner::get_stats(), which only reads the workers' atomic slots.
+class MetricsServer {
+private:
+    const Config& config;
+    Miner& miner;
+    const SystemStats& system;
+    int listen_fd = -1;
+    std::atomic<bool> running{false};
+    std::thread server_thread;
+
+    void serve();
+    void handle(int client_fd);
+    std::string render_prometheus() const;
+    std::string render_summary() const;
+    std::string render_workers() const;
+    // Applies a POST /api/workers query, returns the HTTP status
+    int scale_workers(const std::string& query);
+
+public:
+    MetricsServer(const Config& cfg, Miner& miner, const SystemStats& system);
+    ~MetricsServer();
+
+    bool start(const std::string& host, int port);
+    void stop();
+};
+
+#endif
@@ -3,18 +3,164 @@
 
 #include "config.h"
 #include "network.h"
+#include "difficulty.h"
+#include "histogram.h"
+#include "perf_counters.h"
+#include "share_journal.h"
+#include "topology.h"
+#include "hasher.h"
 #include <atomic>
+#include <cstdint>
 #include <vector>
 #include <thread>
 #include <memory>
 #include <mutex>
+#include <chrono>
+#include <condition_variable>
 
-struct MiningStats {
+// Where a worker's wall time goes, one bucket per stage of the job lifecycle
+enum WorkerPhase {
+    PHASE_CONNECT = 0,  // connect + banner, reconnect back-off
+    PHASE_JOB,          // JOB request round trip
+    PHASE_DECODE,       // parsing the job, hex decode
+    PHASE_HASHING,
+    PHASE_SUBMIT,       // share round trip
+    PHASE_LOG,          // share logging and bookkeeping
+    PHASE_THROTTLE,     // duty-cycle / hashrate cap sleep
+    PHASE_PAUSED,
+    PHASE_COUNT
+};
+
+// Lifecycle of a worker slot, see Miner::set_workers
+enum WorkerState {
+    WORKER_IDLE = 0,    // no thread
+    WORKER_RUNNING,
+    WORKER_RETIRING     // finishing its job, then exits
+};
+
+// Per-worker counters. Each worker is the only writer of its own slot and
+// publishes with relaxed stores, so readers (reporter, get_stats, 's') can sum
+// the slots at any time without blocking workers. Slots are cache-line
+// aligned so neighbouring workers never write to the same line.
+struct alignas(64) WorkerStats {
+    std::atomic<double> hashrate{0.0};
+    std::atomic<uint64_t> hashes{0};
+    std::atomic<uint64_t> jobs{0};
+    std::atomic<uint64_t> ns_phase[PHASE_COUNT] = {};
+    std::atomic<uint64_t> perf[PERF_EVENT_COUNT] = {};  // during hashing only
+    std::atomic<int> pool{-1};
+    std::atomic<int> tier{0};
+    std::atomic<int> solve_ms{0};
+    std::atomic<int> useful_permille{1000};
+    std::atomic<int> phase{PHASE_CONNECT};
+    std::atomic<int> tid{0};                // kernel thread id, for /proc/self/task
+    std::atomic<int> core_class{CORE_PERFORMANCE};
+    std::atomic<int> node{0};               // index into MiningStats::nodes
+    std::atomic<int> state{WORKER_IDLE};
+    IoCounters io;                          // this worker's pool connections
+
+    // Single-writer increment: no locked read-modify-write needed
+    static void add(std::atomic<uint64_t>& counter, uint64_t n) {
+        counter.store(counter.load(std::memory_order_relaxed) + n,
+                      std::memory_order_relaxed);
+    }
+};
+
+// Per-worker latency distributions, recorded on every job and share
+struct WorkerLatency {
+    LatencyHistogram job_rtt;       // JOB request -> job line
+    LatencyHistogram solve_time;    // job received -> nonce found
+    LatencyHistogram submit_rtt;    // share sent -> verdict
+};
+
+// Rolling hashrates (XMRig style 10s/60s/15m), maintained once a second by
+// the reporter from the workers' hash counters
+struct HashrateWindows {
+    std::atomic<double> h10s{0.0};
+    std::atomic<double> h60s{0.0};
+    std::atomic<double> h15m{0.0};
+};
+
+// Share counters written by every worker on one NUMA node. Workers only
+// touch their own node's block, so on a multi-socket machine these lines
+// never bounce across the interconnect; readers add up the nodes.
+struct alignas(64) NodeStats {
     std::atomic<unsigned long> accepted{0};
     std::atomic<unsigned long> rejected{0};
     std::atomic<unsigned long> blocks{0};
-    std::vector<double> thread_hashrates;
-    mutable std::mutex hashrate_mutex;
+    // Pool traffic (both directions) spent per tier, split at share
+    // verdicts, and the accepted shares it bought
+    std::atomic<uint64_t> tier_bytes[DIFF_TIER_COUNT] = {};
+    std::atomic<uint64_t> tier_accepted[DIFF_TIER_COUNT] = {};
+};
+
+struct MiningStats {
+    std::unique_ptr<WorkerStats[]> workers;
+    std::unique_ptr<WorkerLatency[]> latency;
+    std::unique_ptr<HashrateWindows[]> windows;
+    std::unique_ptr<NodeStats[]> nodes;
+    std::vector<int> node_ids;              // NUMA node of each NodeStats
+    HashrateWindows total;
+    std::atomic<double> max_hashrate{0.0};  // highest 10s total seen
+    // Sum of the workers' last share hashrates, refreshed by the reporter
+    // so a share log line does not walk every worker
+    std::atomic<double> hashrate_sum{0.0};
+    int worker_count = 0;                   // slots allocated, Config::max_workers
+};
+
+struct ThreadSnapshot {
+    double hashrate;
+    double hashrate_10s;
+    double hashrate_60s;
+    double hashrate_15m;
+    int pool;
+    int tier;
+    int solve_ms;
+    int useful_permille;
+    uint64_t hashes;
+    uint64_t jobs;
+    HistogramSummary job_rtt;
+    HistogramSummary solve_time;
+    HistogramSummary submit_rtt;
+    uint64_t ns_phase[PHASE_COUNT];
+    uint64_t perf[PERF_EVENT_COUNT];
+    int phase;
+    IoSnapshot io;
+    int tid;
+    int core_class;
+    int state;
+};
+
+// Workers of one core class on a hybrid CPU
+struct ClassSnapshot {
+    int threads = 0;
+    double hashrate = 0.0;      // 10s
+    double weight = 1.0;        // share of the work split relative to a P-core
+    std::string difficulty;     // starting tier
+    std::string kernel;         // digest compare
+};
+
+// Workers pinned to one NUMA node; unpinned workers count as the first node
+struct NodeSnapshot {
+    int node = 0;
+    int threads = 0;
+    double hashrate = 0.0;      // 10s
+    unsigned long accepted = 0;
+    unsigned long rejected = 0;
+    unsigned long blocks = 0;
+};
+
+struct PoolSnapshot {
+    PoolInfo pool;
+    int workers;
+    double hashrate;
+    unsigned long accepted;
+    unsigned long rejected;
+    unsigned long blocks;
+    int rtt_ms;
+    HistogramSummary job_rtt;
+    HistogramSummary solve_time;
+    HistogramSummary submit_rtt;
 };
 
 struct MiningStatsSnapshot {
@@ -22,6 +168,20 @@ struct MiningStatsSnapshot {
     unsigned long rejected;
     unsigned long blocks;
     double total_hashrate;
+    double hashrate_10s;
+    double hashrate_60s;
+    double hashrate_15m;
+    double max_hashrate;
+    uint64_t hashes;                            // every slot, retired ones included
+    uint64_t uptime_ns;
+    IoSnapshot io;                              // every socket in the process
+    int workers;                                // target worker count
+    int max_workers;
+    double bytes_per_share[DIFF_TIER_COUNT];    // 0 until a share is accepted
+    ClassSnapshot classes[CORE_CLASS_COUNT];
+    std::vector<NodeSnapshot> nodes;
+    std::vector<PoolSnapshot> pools;
+    std::vector<ThreadSnapshot> threads;
 };
 
 class Miner {
@@ -29,36 +189,88 @@ private:
     Config config;
     NetworkManager& network;
     MiningStats stats;
-    std::vector<std::unique_ptr<std::thread>> threads;
+    std::vector<std::unique_ptr<std::thread>> threads;  // per slot
+    std::unique_ptr<std::thread> reporter;
     std::atomic<bool> running{false};
+    // Slots [0, target) should be running; workers at or above it retire.
+    // Written under scale_mutex, read by every worker between batches.
+    std::atomic<int> target{0};
+    std::atomic<unsigned> scale_epoch{0};   // bumped when target changes
+    std::mutex scale_mutex;
+    std::chrono::steady_clock::time_point launch_time;
+    std::atomic<bool> first_job{true};
+    std::atomic<bool> paused{false};
+    std::mutex pause_mutex;
+    std::condition_variable pause_cv;
+    std::vector<uint64_t> sampled_hashes;   // reporter-only
+    std::chrono::steady_clock::time_point sample_time;
+    ShareJournal journal;
+    CpuLimits limits;
+    Topology topology;
+    std::vector<int> worker_cpus;           // per worker, empty = not pinned
+    // Per core class: starting difficulty, digest compare and work weight
+    std::string class_diff[CORE_CLASS_COUNT];
+    std::string class_kernel_name[CORE_CLASS_COUNT];
+    Hasher::CompareKernel class_kernel[CORE_CLASS_COUNT] = {};
+    double class_weight[CORE_CLASS_COUNT] = {1.0, 1.0};
+    // Per slot, see assign_pool; laid out again over the running workers
+    // whenever the count changes
+    std::unique_ptr<std::atomic<double>[]> pool_position;
     
     void mining_thread(int thread_id);
-    bool get_job(SocketClient& client, std::string& last_hash, 
+    void sample_hashrates();
+    void setup_classes();
+    void setup_nodes();
+    void layout_pools(int count);
+    void reconcile_workers();
+    bool retiring(int thread_id) const {
+        return thread_id >= target.load(std::memory_order_relaxed);
+    }
+    double hashrate_cap(int core_class) const;
+    void share_counts(unsigned long& accepted, unsigned long& rejected) const;
+    std::chrono::steady_clock::duration wait_if_paused(int thread_id);
+    // After more than pause_refresh seconds parked the job and session are
+    // stale; waits this worker's share of a 0-5 s spread and returns true
+    bool refresh_after_pause(std::chrono::steady_clock::duration parked, int thread_id) const;
+    double total_hashrate() const;
+    bool get_job(SocketClient& client, const char* diff_tier, std::string& last_hash, 
                  std::string& expected_hash, int& difficulty);
     bool submit_share(SocketClient& client, unsigned long result, 
                      double hashrate, int thread_id, int difficulty,
-                     double compute_time, int ping);
+                     uint64_t job_rtt_us, int pool_index,
+                     uint64_t solve_us, int& submit_rtt, std::string& reason,
+                     const char*& verdict);
+    void log_share(int thread_id, const char* verdict, double hashrate,
+                   int difficulty, double compute_time, int ping);
     
 public:
     Miner(const Config& cfg, NetworkManager& net);
     ~Miner();
     
     bool initialize();
+    const CpuLimits& cpu_limits() const { return limits; }
     void start();
     void stop();
-    MiningStatsSnapshot get_stats() const {
-        std::lock_guard<std::mutex> lock(stats.hashrate_mutex);
-        double total = 0.0;
-        for (double hr : stats.thread_hashrates) {
-            total += hr;
-        }
-        return {
-            stats.accepted.load(),
-            stats.rejected.load(),
-            stats.blocks.load(),
-            total
-        };
-    }
+    
+    // Grows or shrinks the running workers to count (1..max_workers) without
+    // touching the others' pool sessions. Added workers reuse the lowest free
+    // slots and their CPUs; retired ones are the highest, finish their
+    // current job (or drop it after retire_grace seconds) and disconnect.
+    // Returns the new count.
+    int set_workers(int count);
+    int workers() const { return target.load(); }
+    int max_workers() const { return stats.worker_count; }
+    
+    // Parks all workers on a condition variable (no CPU use) while keeping
+    // their pool sessions and current jobs; resume continues where they were
+    void pause();
+    void resume();
+    bool is_paused() const { return paused.load(); }
+    void set_launch_time(std::chrono::steady_clock::time_point t) { launch_time = t; }
+    MiningStatsSnapshot get_stats() const;
+    
+    static const char* phase_name(int phase);
+    static const char* state_name(int state);
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,84 @@
+#ifndef MPSC_QUEUE_H
+#define MPSC_QUEUE_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <utility>
+
+// Bounded lock-free queue for many producers and one consumer (Vyukov's
+// ring with a sequence number per slot). Producers claim a slot with one
+// CAS and never wait for each other or for the consumer: try_push() fails
+// when the ring is full and the caller decides what to drop.
+template <typename T>
+class MpscQueue {
+public:
+    // capacity is rounded up to a power of two
+    explicit MpscQueue(size_t capacity) {
+        size_t size = 2;
+        while (size < capacity) size <<= 1;
+        mask = size - 1;
+        slots.reset(new Slot[size]);
+        for (size_t i = 0; i < size; i++) {
+            slots[i].seq.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    MpscQueue(const MpscQueue&) = delete;
+    MpscQueue& operator=(const MpscQueue&) = delete;
+
+    size_t capacity() const { return mask + 1; }
+
+    bool try_push(T&& value) {
+        size_t pos = tail.load(std::memory_order_relaxed);
+        Slot* slot;
+        while (true) {
+            slot = &slots[pos & mask];
+            size_t seq = slot->seq.load(std::memory_order_acquire);
+            intptr_t diff = (intptr_t)seq - (intptr_t)pos;
+            if (diff == 0) {
+                if (tail.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) break;
+            } else if (diff < 0) {
+                return false;   // full
+            } else {
+                pos = tail.load(std::memory_order_relaxed);
+            }
+        }
+        slot->value = std::move(value);
+        slot->seq.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer side; only one thread may pop at a time
+    bool try_pop(T& value) {
+        size_t pos = head.load(std::memory_order_relaxed);
+        Slot* slot = &slots[pos & mask];
+        size_t seq = slot->seq.load(std::memory_order_acquire);
+        if ((intptr_t)seq - (intptr_t)(pos + 1) < 0) return false;   // empty
+        value = std::move(slot->value);
+        slot->seq.store(pos + mask + 1, std::memory_order_release);
+        head.store(pos + 1, std::memory_order_relaxed);
+        return true;
+    }
+
+    // Consumer side
+    bool empty() const {
+        size_t pos = head.load(std::memory_order_relaxed);
+        size_t seq = slots[pos & mask].seq.load(std::memory_order_acquire);
+        return (intptr_t)seq - (intptr_t)(pos + 1) < 0;
+    }
+
+private:
+    struct Slot {
+        std::atomic<size_t> seq;
+        T value;
+    };
+
+    std::unique_ptr<Slot[]> slots;
+    size_t mask = 0;
+    alignas(64) std::atomic<size_t> tail{0};
+    alignas(64) std::atomic<size_t> head{0};
+};
+
+#endif
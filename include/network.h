@@ -3,37 +3,150 @@
 
 #include <string>
 #include <vector>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include "histogram.h"
+#include <cstdint>
+#include <sys/types.h>
 
 struct PoolInfo {
     std::string ip;
     int port;
     std::string name;
+    int weight = 1;
+};
+
+// Per-pool counters, updated lock-free by the workers sharded onto the pool
+struct PoolStats {
+    std::atomic<unsigned long> accepted{0};
+    std::atomic<unsigned long> rejected{0};
+    std::atomic<unsigned long> blocks{0};
+    std::atomic<int> rtt_ms{0};     // smoothed share verdict RTT
+    std::atomic<int> workers{0};    // threads currently assigned
+    LatencyHistogram job_rtt;
+    LatencyHistogram solve_time;
+    LatencyHistogram submit_rtt;
+};
+
+#define MAX_POOLS 16
+
+struct IoSnapshot {
+    uint64_t bytes_sent = 0;
+    uint64_t bytes_received = 0;
+    uint64_t messages_sent = 0;       // protocol lines
+    uint64_t messages_received = 0;
+    uint64_t syscalls = 0;            // socket-level calls: send, recv, poll, setsockopt...
+    uint64_t connects = 0;            // successful connects, so reconnects = connects - 1
+};
+
+// Socket I/O accounting. A connection's counters have a single writer (the
+// thread using the socket) and are bumped with relaxed load/store pairs.
+// Sockets without counters of their own (pool picker, HTTP) go to the shared
+// SocketClient::totals with fetch_add; process totals are totals plus every
+// worker's counters, so workers never write a shared line per syscall.
+struct IoCounters {
+    std::atomic<uint64_t> bytes_sent{0};
+    std::atomic<uint64_t> bytes_received{0};
+    std::atomic<uint64_t> messages_sent{0};
+    std::atomic<uint64_t> messages_received{0};
+    std::atomic<uint64_t> syscalls{0};
+    std::atomic<uint64_t> connects{0};
+
+    IoSnapshot snapshot() const {
+        IoSnapshot s;
+        s.bytes_sent = bytes_sent.load(std::memory_order_relaxed);
+        s.bytes_received = bytes_received.load(std::memory_order_relaxed);
+        s.messages_sent = messages_sent.load(std::memory_order_relaxed);
+        s.messages_received = messages_received.load(std::memory_order_relaxed);
+        s.syscalls = syscalls.load(std::memory_order_relaxed);
+        s.connects = connects.load(std::memory_order_relaxed);
+        return s;
+    }
 };
 
 class NetworkManager {
 private:
-    PoolInfo current_pool;
-    
+    std::vector<PoolInfo> pools;
+    std::unique_ptr<PoolStats[]> stats;
+    std::string balance = "weighted";
+    mutable std::mutex pool_mutex;
+    std::string cache_file;
+    int cache_ttl = 0;
+    struct RefreshState;
+    std::shared_ptr<RefreshState> refresh;     // background getPool, shared with its thread
+
+    int pick_adaptive() const;
+    static bool parse_pool(const std::string& response, PoolInfo& pool);
+    // getPool answer, errors logged; touches no member, so an abandoned
+    // refresh may still finish it after shutdown
+    static bool request_pool(PoolInfo& pool);
+    void use_pool(const PoolInfo& pool);
+
 public:
+    NetworkManager();
+    ~NetworkManager();
+
     bool initialize();
     bool fetch_pool();
-    PoolInfo get_pool() const { return current_pool; }
+
+    // On-disk cache of the last good getPool answer
+    void set_cache(const std::string& file, int ttl_seconds);
+    bool load_cached_pool(bool allow_stale);
+    void refresh_pool_async();
+    void set_pools(const std::vector<PoolInfo>& list, const std::string& mode);
+
+    // Sharding: map worker threads onto pools by weight, or adaptively by
+    // observed accept rate and RTT ("adaptive" mode). position is the middle
+    // of the worker's slice of the total work weight, in [0, 1).
+    int assign_pool(double position);
+    void release_pool(int index);
+    bool is_adaptive() const { return balance == "adaptive"; }
+    void record_job(int index, uint64_t rtt_us);
+    void record_share(int index, bool accepted, bool block, uint64_t solve_us,
+                      uint64_t rtt_us);
+
+    PoolInfo get_pool() const { return get_pool(0); }
+    PoolInfo get_pool(int index) const;
+    int pool_count() const;
+    const PoolStats& get_pool_stats(int index) const { return stats[index]; }
 };
 
 class SocketClient {
 private:
     int sockfd;
     bool connected;
-    
+    std::string rx_buffer;  // bytes received past the last returned line
+    IoCounters* counters = nullptr;
+
+    void account(std::atomic<uint64_t> IoCounters::*field, uint64_t n);
+    std::string read_message(int timeout, bool banner);
+
 public:
+    // Sockets without set_counters (HTTP client, pool picker)
+    static IoCounters totals;
+
     SocketClient();
     ~SocketClient();
-    
+
     bool connect(const std::string& host, int port, int timeout);
     bool send(const std::string& data);
+    // One '\n'-terminated line, "" on timeout or a closed connection
     std::string receive(int timeout);
+    // The pool's version banner, which has no newline: returned once the
+    // peer stays quiet for a moment after sending it
+    std::string receive_banner(int timeout);
     void disconnect();
     bool is_connected() const { return connected; }
+
+    // Raw byte I/O for protocols that are not line based (HTTP, TLS)
+    bool send_raw(const char* data, size_t len);
+    ssize_t receive_raw(char* buffer, size_t len, int timeout);
+    int get_fd() const { return sockfd; }
+
+    // Per-connection counters, written only by the thread using this socket
+    void set_counters(IoCounters* io) { counters = io; }
 };
 
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,50 @@
+#ifndef PERF_COUNTERS_H
+#define PERF_COUNTERS_H
+
+#include <string>
+#include <cstdint>
+
+enum PerfEvent {
+    PERF_CYCLES = 0,
+    PERF_INSTRUCTIONS,
+    PERF_BRANCH_MISSES,
+    PERF_L1D_MISSES,
+    PERF_EVENT_COUNT
+};
+
+struct PerfSample {
+    uint64_t value[PERF_EVENT_COUNT];
+};
+
+// Hardware counters of the calling thread (perf_event_open, user space
+// only, so perf_event_paranoid <= 2 is enough). Events the CPU or the
+// hypervisor does not offer are left out; if none can be opened the object
+// stays closed and reads return false.
+class PerfCounters {
+private:
+    int fds[PERF_EVENT_COUNT];
+    int group_fd = -1;
+    int order[PERF_EVENT_COUNT];   // event of each value in a group read
+    int opened = 0;
+
+public:
+    PerfCounters();
+    ~PerfCounters();
+    PerfCounters(const PerfCounters&) = delete;
+    PerfCounters& operator=(const PerfCounters&) = delete;
+
+    // Must be called on the thread to be measured
+    bool open();
+    bool is_open() const { return group_fd >= 0; }
+    bool has(int event) const { return fds[event] >= 0; }
+
+    // Counts since open(), scaled when the kernel multiplexed the group
+    bool read(PerfSample& sample) const;
+
+    // Why open() failed, for a one-time warning
+    static std::string last_error();
+
+    static const char* event_name(int event);
+};
+
+#endif
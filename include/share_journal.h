@@ -0,0 +1,106 @@
+#ifndef SHARE_JOURNAL_H
+#define SHARE_JOURNAL_H
+
+#include "mpsc_queue.h"
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+// Append-only binary journal of every job and share, for payout
+// reconciliation and offline tuning (read with duino-journal). A file is a
+// JournalFileHeader followed by fixed-size JournalRecords in native byte
+// order. Every file starts with the POOL records needed to resolve the pool
+// indexes in it, so rotated files can be read on their own.
+#define JOURNAL_MAGIC "DUCOJRNL"
+#define JOURNAL_VERSION 1
+#define JOURNAL_QUEUE_SIZE 8192
+
+enum JournalType : uint8_t { JOURNAL_POOL, JOURNAL_JOB, JOURNAL_SHARE };
+enum JournalVerdict : uint8_t {
+    JOURNAL_NONE,       // jobs and pools
+    JOURNAL_ACCEPT,
+    JOURNAL_REJECT,
+    JOURNAL_BLOCK,
+    JOURNAL_LOST        // no answer from the pool
+};
+
+struct JournalFileHeader {
+    char magic[8];
+    uint16_t version;
+    uint16_t record_size;
+    uint32_t reserved;
+};
+
+struct JournalRecord {
+    uint64_t time_us;       // wall clock, microseconds since the epoch
+    uint8_t type;           // JournalType
+    uint8_t verdict;        // JournalVerdict
+    uint16_t thread;
+    uint16_t pool;          // index into the POOL records
+    uint16_t reserved;
+    uint32_t difficulty;
+    uint32_t nonce;
+    uint32_t solve_us;      // job received -> share found
+    uint32_t job_rtt_us;
+    uint32_t submit_rtt_us;
+    char text[28];          // reject reason or pool address, NUL-padded
+};
+
+static_assert(sizeof(JournalFileHeader) == 16, "journal header layout");
+static_assert(sizeof(JournalRecord) == 64, "journal record layout");
+
+// Workers hand records to a background writer through a lock-free queue;
+// the writer batches them into one write() per wakeup, fsyncs every
+// fsync_interval seconds and rotates at max_bytes (file -> file.1 -> ...).
+// A full queue drops the record and counts it rather than stall a worker.
+class ShareJournal {
+private:
+    std::string path;
+    uint64_t max_bytes = 0;
+    int keep = 0;
+    int fsync_interval = 0;
+    int fd = -1;
+    uint64_t file_size = 0;
+    std::vector<char> buffer;
+    std::vector<std::string> pools;             // writer-only
+    std::unique_ptr<MpscQueue<JournalRecord>> queue;
+    std::atomic<bool> active{false};
+    std::atomic<unsigned long long> dropped{0};
+    unsigned long long reported_drops = 0;
+    bool running = false;
+    std::mutex mutex;
+    std::condition_variable cv;
+    std::thread writer_thread;
+
+    void run();
+    bool open_file();
+    void close_file();
+    void rotate();
+    void append(const JournalRecord& record);
+    bool flush();
+
+public:
+    ShareJournal() = default;
+    ~ShareJournal();
+
+    bool open(const std::string& file, uint64_t max_bytes, int keep, int fsync_interval);
+    void close();
+    bool is_open() const { return active.load(std::memory_order_relaxed); }
+
+    // Safe from any thread; a no-op while closed
+    void record(JournalRecord record);
+    void pool(int index, const std::string& address);
+    void job(int thread, int pool, int difficulty, uint32_t job_rtt_us);
+    void share(int thread, int pool, int difficulty, uint32_t nonce, uint32_t solve_us,
+               uint32_t job_rtt_us, uint32_t submit_rtt_us, JournalVerdict verdict,
+               const std::string& reason);
+
+    unsigned long long dropped_records() const { return dropped.load(); }
+};
+
+#endif
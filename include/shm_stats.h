@@ -0,0 +1,90 @@
+#ifndef SHM_STATS_H
+#define SHM_STATS_H
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+// Layout of the POSIX shared-memory stats segment (shm_open name from
+// shm_name, e.g. /dev/shm/duino-cpu). Readers map it read-only and use the
+// seqlock: read seq (retry while odd), copy, read seq again, retry if it
+// changed. Fields are only ever appended; readers check version and use
+// header_size / thread_stride so older readers keep working.
+#define SHM_STATS_MAGIC 0x4f435544u     // "DUCO"
+#define SHM_STATS_VERSION 1
+
+struct ShmThreadStats {
+    double hashrate_10s;
+    double hashrate_60s;
+    double hashrate_15m;
+    uint64_t hashes;
+    uint64_t jobs;
+    int32_t pool;
+    int32_t tier;           // 0 LOW, 1 MEDIUM, 2 NET
+    int32_t phase;          // WorkerPhase the thread is in
+    int32_t reserved;
+    float job_rtt_p50_ms;
+    float job_rtt_p99_ms;
+    float submit_rtt_p50_ms;
+    float submit_rtt_p99_ms;
+    float solve_p50_ms;
+    float solve_p99_ms;
+};
+
+struct ShmStatsHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t header_size;
+    uint32_t thread_stride;
+    uint32_t thread_count;      // rows in use; runtime scaling moves it within the segment
+    int32_t pid;
+    std::atomic<uint64_t> seq;  // odd while the miner is writing
+    uint64_t update_unix_ns;
+    uint64_t uptime_ns;
+    uint64_t accepted;
+    uint64_t rejected;
+    uint64_t blocks;
+    double hashrate_10s;
+    double hashrate_60s;
+    double hashrate_15m;
+    double hashrate_max;
+    uint32_t paused;
+    uint32_t reserved;
+    char version_string[16];
+    char rig[64];
+    char kernel[32];
+};
+
+class Miner;
+
+// Copies a Miner::get_stats() snapshot into the segment every interval_ms
+// on a background thread; workers never touch the segment.
+class ShmStatsPublisher {
+private:
+    const Miner& miner;
+    std::string name;
+    int interval_ms = 250;
+    void* base = nullptr;
+    size_t size = 0;
+    int thread_count = 0;
+    bool running = false;
+    std::mutex mutex;
+    std::condition_variable cv;
+    std::thread publisher_thread;
+
+    void run();
+    void publish();
+
+public:
+    explicit ShmStatsPublisher(const Miner& miner);
+    ~ShmStatsPublisher();
+
+    bool start(const std::string& shm_name, int threads, int interval_ms,
+               const std::string& rig);
+    void stop();
+};
+
+#endif
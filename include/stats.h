@@ -4,18 +4,88 @@
 #include <string>
 #include <atomic>
 #include <chrono>
+#include <cstdint>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
 
+class Miner;
+struct IoSnapshot;
+
+// One pass of the system sampler. Usage is in percent of one CPU (200 = two
+// cores busy) except system_usage, which is of the whole machine.
+struct CpuSample {
+    double system_usage = 0.0;          // /proc/stat, all CPUs
+    double pressure = -1.0;             // /proc/pressure/cpu "some" stall time, -1 = no PSI
+    double process_usage = 0.0;         // every miner thread
+    double hashes_per_cpu_second = 0.0; // all hashes over the miner's CPU time
+    double throttled = -1.0;            // share of quota periods throttled, -1 = no cpu.stat
+    unsigned long long throttled_periods = 0;   // cgroup cpu.stat, cumulative
+    double throttled_seconds = 0.0;
+    std::vector<double> thread_usage;
+    std::vector<double> thread_cpu_seconds;     // since the worker started
+    std::vector<double> thread_hashes_per_cpu_second;
+};
+
+// /proc readers keep their files open and re-read them with pread, so a
+// sample costs a handful of syscalls and no allocation on /proc
 struct SystemStats {
     std::chrono::steady_clock::time_point start_time;
     std::atomic<unsigned long> shares_sent{0};
-    std::atomic<unsigned long> data_bytes_sent{0};
-    std::atomic<unsigned long> data_bytes_received{0};
     
     SystemStats() : start_time(std::chrono::steady_clock::now()) {}
+    ~SystemStats();
+    
+    // Samples every interval seconds on a background thread; the getters
+    // only return the last sample and never touch /proc
+    void start_sampler(const Miner& miner, int interval_seconds);
+    void stop_sampler();
+    CpuSample get_sample() const;
     
     std::string get_uptime() const;
     double get_cpu_usage() const;
     std::string get_cpu_name() const;
+    
+    // /proc/cpuinfo model name, read once
+    static const std::string& cpu_name();
+
+private:
+    struct TaskFile {
+        int tid = 0;
+        int fd = -1;
+        bool read = false;
+        unsigned long long ticks = 0;
+        uint64_t hashes = 0;
+    };
+    
+    const Miner* miner = nullptr;
+    int interval = 1;
+    int stat_fd = -1;
+    int self_fd = -1;
+    int pressure_fd = -1;
+    int cpu_stat_fd = -1;               // cgroup cpu.stat
+    unsigned long long last_total = 0;
+    unsigned long long last_idle = 0;
+    unsigned long long last_process = 0;
+    unsigned long long last_stall_us = 0;
+    unsigned long long last_periods = 0;
+    unsigned long long last_throttled = 0;
+    std::chrono::steady_clock::time_point throttle_warned;
+    uint64_t last_hashes = 0;
+    std::chrono::steady_clock::time_point last_time;
+    std::vector<TaskFile> tasks;        // sampler thread only
+    
+    CpuSample current;
+    mutable std::mutex sample_mutex;
+    bool running = false;
+    std::mutex mutex;
+    std::condition_variable cv;
+    std::thread sampler_thread;
+    
+    void run();
+    void sample();
+    void close_files();
 };
 
 class StatsDisplay {
@@ -24,7 +94,8 @@ public:
                           unsigned long accepted,
                           unsigned long rejected,
                           const std::string& pool_address,
-                          int pool_port);
+                          int pool_port,
+                          const IoSnapshot& io);
     
 private:
     static std::string format_bytes(unsigned long bytes);
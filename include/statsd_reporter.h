@@ -0,0 +1,47 @@
+#ifndef STATSD_REPORTER_H
+#define STATSD_REPORTER_H
+
+#include "config.h"
+#include "miner.h"
+#include <string>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+// Pushes counters and gauges over UDP every report_interval seconds, for
+// rigs that cannot be scraped. Lines use the DogStatsD format with rig and
+// thread tags, or plain StatsD with the tags folded into the metric name.
+// Datagrams are packed up to statsd_mtu bytes and sent non-blocking; a full
+// socket buffer drops the rest of the batch instead of stalling.
+class StatsdReporter {
+private:
+    const Config& config;
+    const Miner& miner;
+    int sockfd = -1;
+    bool running = false;
+    std::mutex mutex;
+    std::condition_variable cv;
+    std::thread reporter_thread;
+
+    // Last pushed totals, for StatsD counter deltas
+    unsigned long last_accepted = 0;
+    unsigned long last_rejected = 0;
+    unsigned long last_blocks = 0;
+    std::vector<uint64_t> last_hashes;
+
+    void run();
+    void push();
+    void send_batch(const std::vector<std::string>& lines);
+    std::string metric(const std::string& name, double value, const char* type,
+                       const std::string& tags) const;
+
+public:
+    StatsdReporter(const Config& cfg, const Miner& miner);
+    ~StatsdReporter();
+
+    bool start(const std::string& host, int port);
+    void stop();
+};
+
+#endif
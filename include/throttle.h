@@ -0,0 +1,49 @@
+#ifndef THROTTLE_H
+#define THROTTLE_H
+
+#include <cstdint>
+
+#define THROTTLE_BATCH_NS 2000000     // hashing time between control steps
+#define THROTTLE_MAX_CREDIT_NS 20000000  // idle time that may be "spent" later
+#define THROTTLE_MIN_BATCH 256
+#define THROTTLE_MAX_BATCH 65536
+
+// Closed-loop CPU limiter for one worker thread. Holds the thread's CPU time
+// (CLOCK_THREAD_CPUTIME_ID) at duty_percent of wall time and/or its hash
+// count at max_hashrate per second, sleeping to an absolute deadline so timer
+// slack is corrected on the next step.
+class Throttle {
+private:
+    int duty_percent;
+    double max_hashrate;
+    bool active;
+    uint64_t batch_size;
+
+    int64_t wall_start = 0;
+    int64_t cpu_start = 0;
+    uint64_t hashes = 0;
+    int64_t last_wall = 0;
+    int64_t last_cpu = 0;
+    int64_t slept_ns = 0;
+
+    void restart(int64_t wall, int64_t cpu);
+
+public:
+    Throttle(int duty_percent, double max_hashrate);
+
+    bool is_active() const { return active; }
+    uint64_t get_batch() const { return batch_size; }
+    int64_t get_slept_ns() const { return slept_ns; }
+
+    // New hash cap from the next tick on; the window restarts so the old
+    // rate is not made up for
+    void set_max_hashrate(double rate);
+
+    // Account a finished batch and sleep as needed
+    void tick(uint64_t batch_hashes);
+
+    static int64_t wall_ns();
+    static int64_t thread_cpu_ns();
+};
+
+#endif
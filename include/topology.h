@@ -0,0 +1,87 @@
+#ifndef TOPOLOGY_H
+#define TOPOLOGY_H
+
+#include <string>
+#include <vector>
+#include <pthread.h>
+#include "cpu_limits.h"
+
+// Hybrid CPUs (Intel P/E cores, ARM big.LITTLE); everything else is
+// CORE_PERFORMANCE
+enum CoreClass {
+    CORE_PERFORMANCE = 0,
+    CORE_EFFICIENCY,
+    CORE_CLASS_COUNT
+};
+
+// One logical CPU as described by sysfs
+struct CpuInfo {
+    int cpu = 0;
+    int core = 0;       // core_id, unique within its package
+    int package = 0;    // physical_package_id
+    int node = 0;       // NUMA node
+    int sibling = 0;    // 0 for the first hardware thread of its core, 1 for the next
+    int capacity = 1024;    // cpu_capacity, 1024 = the fastest core
+    int core_class = CORE_PERFORMANCE;
+};
+
+// CPU layout from /sys/devices/system/cpu and /sys/devices/system/node. Every
+// path is prefixed with root, so a fake sysfs tree can stand in for the real
+// one. Without sysfs the CPUs are assumed to be one core each on one node.
+// restrict() then drops the CPUs a cgroup cpuset or affinity mask rules out,
+// so placement never picks a CPU the miner cannot run on.
+//
+// Core classes come from the cpu_core/cpu_atom PMUs under /sys/devices on
+// Intel hybrids, or from per-CPU cpu_capacity elsewhere: the highest capacity
+// is the performance class, anything lower is efficiency. Performance cores
+// are always placed before efficiency cores.
+//
+// Placement policies, for `count` workers:
+//   scatter   one worker per physical core, alternating NUMA nodes, before
+//             any SMT sibling gets a second one (default)
+//   compact   fill each core's hardware threads, then the next core, node by
+//             node, to keep the miner on as few cores and nodes as possible
+//   physical  first hardware thread of each core only; extra workers wrap
+//             around onto the same cores
+//   none      no pinning, the scheduler decides
+class Topology {
+private:
+    std::vector<CpuInfo> cpus;                  // sorted by CPU number
+    std::vector<std::vector<int>> core_cpus;    // per physical core, sibling order
+    int node_count = 1;
+    int class_count[CORE_CLASS_COUNT] = {};     // CPUs per class
+
+    void detect_classes(const std::string& root);
+    void count_classes();
+    void group_cores();
+
+public:
+    bool load(const std::string& root = "");
+    // Drops CPUs outside the affinity mask and cpuset
+    void restrict(const CpuLimits& limits);
+
+    const std::vector<CpuInfo>& get_cpus() const { return cpus; }
+    int cores() const { return core_cpus.size(); }
+    int nodes() const { return node_count; }
+    bool hybrid() const { return class_count[CORE_EFFICIENCY] > 0; }
+    int class_cpus(int core_class) const { return class_count[core_class]; }
+    // Mean cpu_capacity of the class relative to the performance class, 0
+    // when sysfs has no capacities (Intel)
+    double relative_capacity(int core_class) const;
+    const CpuInfo* find(int cpu) const;
+
+    // CPU for each worker, empty for "none"
+    std::vector<int> place(const std::string& policy, int count) const;
+    // CPUs for everything else: whole cores no worker uses, else unused SMT
+    // siblings; empty when workers cover every CPU
+    std::vector<int> spare(const std::vector<int>& used) const;
+    std::string describe() const;
+
+    static bool valid_policy(const std::string& policy);
+    static bool pin(pthread_t thread, const std::vector<int>& cpus);
+    static std::string format_list(const std::vector<int>& cpus);   // "0-3,8"
+    static std::vector<int> parse_list(const std::string& text);
+    static const char* class_name(int core_class);
+};
+
+#endif
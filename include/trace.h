@@ -0,0 +1,39 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <string>
+#include <cstdint>
+
+#define TRACE_DEFAULT_EVENTS 16384
+
+// Flight recorder for worker timelines. Each worker writes into its own
+// fixed-size ring (oldest events are overwritten) without locks; dump()
+// writes the rings as Chrome Trace JSON, loadable in Perfetto or
+// chrome://tracing. When tracing is off every call is a single branch.
+class Trace {
+public:
+    // Allocates one ring of events_per_thread events per worker
+    static bool enable(const std::string& file, int threads, size_t events_per_thread);
+    static bool is_enabled() { return enabled; }
+
+    // A span [start_ns, end_ns) on the CLOCK_MONOTONIC timeline
+    static void complete(int thread, const char* name, int64_t start_ns, int64_t end_ns,
+                         const char* arg_name = nullptr, int64_t arg = 0) {
+        if (enabled) record(thread, 'X', name, start_ns, end_ns - start_ns, arg_name, arg);
+    }
+    static void instant(int thread, const char* name, int64_t ts_ns,
+                        const char* arg_name = nullptr, int64_t arg = 0) {
+        if (enabled) record(thread, 'i', name, ts_ns, 0, arg_name, arg);
+    }
+
+    // Safe to call while workers are still recording
+    static bool dump();
+
+private:
+    static inline bool enabled = false;
+
+    static void record(int thread, char phase, const char* name, int64_t ts_ns,
+                       int64_t dur_ns, const char* arg_name, int64_t arg);
+};
+
+#endif
@@ -0,0 +1,114 @@
+#include "../include/autoscaler.h"
+#include "../include/logger.h"
+#include <sstream>
+#include <iomanip>
+#include <algorithm>
+
+Autoscaler::Autoscaler(const Config& cfg, Miner& miner, const SystemStats& system)
+    : config(cfg), miner(miner), system(system) {}
+
+Autoscaler::~Autoscaler() {
+    stop();
+}
+
+void Autoscaler::start() {
+    running = true;
+    scaler_thread = std::thread(&Autoscaler::run, this);
+    Logger::info("Autoscaling " + std::to_string(config.autoscale_min) + "-" +
+                 std::to_string(miner.max_workers()) + " workers every " +
+                 std::to_string(config.autoscale_interval) + "s");
+}
+
+void Autoscaler::stop() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        running = false;
+    }
+    cv.notify_all();
+    if (scaler_thread.joinable()) {
+        scaler_thread.join();
+    }
+}
+
+void Autoscaler::run() {
+    std::unique_lock<std::mutex> lock(mutex);
+    while (running) {
+        if (cv.wait_for(lock, std::chrono::seconds(config.autoscale_interval),
+                        [this] { return !running; })) {
+            break;
+        }
+        lock.unlock();
+        step();
+        lock.lock();
+    }
+}
+
+double Autoscaler::wait_share() {
+    MiningStatsSnapshot stats = miner.get_stats();
+    uint64_t wait = 0, total = 0;
+    for (const ThreadSnapshot& ts : stats.threads) {
+        wait += ts.ns_phase[PHASE_CONNECT] + ts.ns_phase[PHASE_JOB] +
+                ts.ns_phase[PHASE_SUBMIT] + ts.ns_phase[PHASE_PAUSED];
+        for (int p = 0; p < PHASE_COUNT; p++) total += ts.ns_phase[p];
+    }
+    // A retired slot drops out of the snapshot and can shrink the sums
+    double share = 0.0;
+    if (total > total_mark && wait >= wait_mark) {
+        share = std::min(1.0, (double)(wait - wait_mark) / (total - total_mark));
+    }
+    wait_mark = wait;
+    total_mark = total;
+    return share;
+}
+
+std::string Autoscaler::contention(const CpuSample& cpu, int workers, double waiting) const {
+    std::ostringstream reason;
+    reason << std::fixed << std::setprecision(1);
+    if (cpu.pressure > config.autoscale_pressure) {
+        reason << "CPU pressure " << cpu.pressure << "%";
+    } else if (cpu.throttled > 0) {
+        reason << "quota throttled in " << cpu.throttled << "% of periods";
+    } else {
+        // Each worker asks for intensity percent of a CPU while it is not
+        // waiting on the pool; a network-bound miner is not starved
+        double wanted = workers * config.intensity * (1.0 - waiting);
+        if (cpu.process_usage > 0 && cpu.process_usage < 0.8 * wanted) {
+            reason << "miner got " << cpu.process_usage << "% CPU of " << wanted << "%";
+        }
+    }
+    return reason.str();
+}
+
+void Autoscaler::step() {
+    double waiting = wait_share();
+    if (settling) {
+        settling = false;
+        return;
+    }
+    if (miner.is_paused()) return;
+
+    CpuSample cpu = system.get_sample();
+    int workers = miner.workers();
+    std::string reason = contention(cpu, workers, waiting);
+
+    if (!reason.empty()) {
+        if (workers <= config.autoscale_min) return;
+        Logger::info("Autoscale: " + reason + ", retiring a worker");
+        miner.set_workers(workers - 1);
+        settling = true;
+        return;
+    }
+
+    // Unused part of what the miner may run on; system_usage is host wide, so
+    // it only caps this when other processes keep the host busy
+    double own_idle = miner.cpu_limits().usable_cpus() - cpu.process_usage / 100.0;
+    double host_idle = (100.0 - cpu.system_usage) / 100.0 * std::thread::hardware_concurrency();
+    double idle_cpus = std::min(own_idle, host_idle);
+    if (idle_cpus >= 1.0 && workers < miner.max_workers()) {
+        std::ostringstream why;
+        why << std::fixed << std::setprecision(1) << idle_cpus;
+        Logger::info("Autoscale: " + why.str() + " CPUs idle, adding a worker");
+        miner.set_workers(workers + 1);
+        settling = true;
+    }
+}
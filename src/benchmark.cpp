@@ -2,15 +2,25 @@
 #include "../include/benchmark.h"
 #include "../include/hasher.h"
 #include "../include/logger.h"
+#include "../include/perf_counters.h"
 #include <chrono>
 #include <thread>
 #include <vector>
 #include <atomic>
 #include <iomanip>
+#include <mutex>
+#include <sstream>
 
 static std::atomic<unsigned long> total_hashes{0};
+static std::mutex perf_mutex;
+static PerfSample perf_total;
+static int perf_threads = 0;
 
-void benchmark_worker(int duration_seconds) {
+void benchmark_worker(int duration_seconds, bool perf) {
+    PerfCounters counters;
+    PerfSample start;
+    bool counting = perf && counters.open() && counters.read(start);
+    
     auto end_time = std::chrono::steady_clock::now() + 
                     std::chrono::seconds(duration_seconds);
     
@@ -26,19 +36,30 @@ void benchmark_worker(int duration_seconds) {
     }
     
     total_hashes += local_hashes;
+    
+    PerfSample end;
+    if (counting && counters.read(end)) {
+        std::lock_guard<std::mutex> lock(perf_mutex);
+        for (int i = 0; i < PERF_EVENT_COUNT; i++) {
+            perf_total.value[i] += end.value[i] - start.value[i];
+        }
+        perf_threads++;
+    }
 }
 
-void Benchmark::run(int threads) {
+void Benchmark::run(int threads, bool perf) {
     Logger::info("Starting benchmark with " + std::to_string(threads) + " threads");
     Logger::info("Running for 30 seconds...");
     
     total_hashes = 0;
+    perf_total = PerfSample();
+    perf_threads = 0;
     std::vector<std::thread> workers;
     
     auto start = std::chrono::steady_clock::now();
     
     for (int i = 0; i < threads; i++) {
-        workers.emplace_back(benchmark_worker, 30);
+        workers.emplace_back(benchmark_worker, 30, perf);
     }
     
     for (auto& worker : workers) {
@@ -56,4 +77,23 @@ void Benchmark::run(int threads) {
     Logger::info("Duration: " + std::to_string(duration) + " seconds");
     Logger::info("Hashrate: " + std::to_string(hashrate/1000.0) + " kH/s");
     Logger::info("Per thread: " + std::to_string(hashrate/threads/1000.0) + " kH/s");
+    
+    if (!perf) return;
+    if (perf_threads < threads) {
+        Logger::warning("Hardware counters unavailable: " + PerfCounters::last_error());
+        return;
+    }
+    
+    // The whole worker loop is measured, so this includes the input formatting
+    double hashes = total_hashes.load();
+    std::stringstream ss;
+    ss << std::fixed << std::setprecision(0)
+       << "Cycles/hash: " << perf_total.value[PERF_CYCLES] / hashes
+       << std::setprecision(2) << "  IPC: "
+       << (perf_total.value[PERF_CYCLES] ?
+           (double)perf_total.value[PERF_INSTRUCTIONS] / perf_total.value[PERF_CYCLES] : 0.0)
+       << std::setprecision(3)
+       << "  Branch misses/hash: " << perf_total.value[PERF_BRANCH_MISSES] / hashes
+       << "  L1d misses/hash: " << perf_total.value[PERF_L1D_MISSES] / hashes;
+    Logger::info(ss.str());
 }
\ No newline at end of file
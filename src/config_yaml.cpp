@@ -34,14 +34,99 @@ bool ConfigYAML::load(const std::string& filename, Config& config) {
             }
         }
         
+        if (yaml_config["pools"]) {
+            config.pools.clear();
+            for (const auto& entry : yaml_config["pools"]) {
+                PoolConfig pool;
+                if (entry["address"]) pool.address = entry["address"].as<std::string>();
+                if (entry["port"]) pool.port = entry["port"].as<int>();
+                if (entry["weight"]) pool.weight = entry["weight"].as<int>();
+                if (!pool.address.empty() && pool.port > 0) {
+                    config.pools.push_back(pool);
+                }
+            }
+        }
+        
+        if (yaml_config["pool_balance"]) {
+            config.pool_balance = yaml_config["pool_balance"].as<std::string>();
+        }
+        
+        if (yaml_config["pool_cache"]) {
+            config.pool_cache = yaml_config["pool_cache"].as<std::string>();
+        }
+        
+        if (yaml_config["pool_cache_ttl"]) {
+            config.pool_cache_ttl = yaml_config["pool_cache_ttl"].as<int>();
+        }
+        
         if (yaml_config["threads"]) {
             config.threads = yaml_config["threads"].as<int>();
         }
         
+        if (yaml_config["max_workers"]) {
+            config.max_workers = yaml_config["max_workers"].as<int>();
+        }
+        
+        if (yaml_config["retire_grace"]) {
+            config.retire_grace = yaml_config["retire_grace"].as<int>();
+        }
+        
+        if (yaml_config["pause_refresh"]) {
+            config.pause_refresh = yaml_config["pause_refresh"].as<int>();
+        }
+        
+        if (yaml_config["autoscale"]) {
+            config.autoscale = yaml_config["autoscale"].as<bool>();
+        }
+        
+        if (yaml_config["autoscale_min"]) {
+            config.autoscale_min = yaml_config["autoscale_min"].as<int>();
+        }
+        
+        if (yaml_config["autoscale_interval"]) {
+            config.autoscale_interval = yaml_config["autoscale_interval"].as<int>();
+        }
+        
+        if (yaml_config["autoscale_pressure"]) {
+            config.autoscale_pressure = yaml_config["autoscale_pressure"].as<double>();
+        }
+        
         if (yaml_config["intensity"]) {
             config.intensity = yaml_config["intensity"].as<int>();
         }
         
+        if (yaml_config["affinity"]) {
+            config.affinity = yaml_config["affinity"].as<std::string>();
+        }
+        
+        if (yaml_config["sysfs_root"]) {
+            config.sysfs_root = yaml_config["sysfs_root"].as<std::string>();
+        }
+        
+        if (yaml_config["kernel"]) {
+            config.kernel = yaml_config["kernel"].as<std::string>();
+        }
+        
+        if (yaml_config["efficiency_diff"]) {
+            config.efficiency_diff = yaml_config["efficiency_diff"].as<std::string>();
+        }
+        
+        if (yaml_config["efficiency_kernel"]) {
+            config.efficiency_kernel = yaml_config["efficiency_kernel"].as<std::string>();
+        }
+        
+        if (yaml_config["efficiency_weight"]) {
+            config.efficiency_weight = yaml_config["efficiency_weight"].as<double>();
+        }
+        
+        if (yaml_config["max_hashrate"]) {
+            config.max_hashrate = yaml_config["max_hashrate"].as<double>();
+        }
+        
+        if (yaml_config["max_hashrate_thread"]) {
+            config.max_hashrate_thread = yaml_config["max_hashrate_thread"].as<double>();
+        }
+        
         if (yaml_config["soc_timeout"]) {
             config.soc_timeout = yaml_config["soc_timeout"].as<int>();
         }
@@ -58,6 +143,90 @@ bool ConfigYAML::load(const std::string& filename, Config& config) {
             config.max_retries = yaml_config["max_retries"].as<int>();
         }
         
+        if (yaml_config["http_host"]) {
+            config.http_host = yaml_config["http_host"].as<std::string>();
+        }
+        
+        if (yaml_config["http_port"]) {
+            config.http_port = yaml_config["http_port"].as<int>();
+        }
+        
+        if (yaml_config["http_control"]) {
+            config.http_control = yaml_config["http_control"].as<bool>();
+        }
+        
+        if (yaml_config["statsd_host"]) {
+            config.statsd_host = yaml_config["statsd_host"].as<std::string>();
+        }
+        
+        if (yaml_config["statsd_port"]) {
+            config.statsd_port = yaml_config["statsd_port"].as<int>();
+        }
+        
+        if (yaml_config["statsd_prefix"]) {
+            config.statsd_prefix = yaml_config["statsd_prefix"].as<std::string>();
+        }
+        
+        if (yaml_config["statsd_format"]) {
+            config.statsd_format = yaml_config["statsd_format"].as<std::string>();
+        }
+        
+        if (yaml_config["statsd_mtu"]) {
+            config.statsd_mtu = yaml_config["statsd_mtu"].as<int>();
+        }
+        
+        if (yaml_config["sample_interval"]) {
+            config.sample_interval = yaml_config["sample_interval"].as<int>();
+        }
+        
+        if (yaml_config["shm_name"]) {
+            config.shm_name = yaml_config["shm_name"].as<std::string>();
+        }
+        
+        if (yaml_config["shm_interval"]) {
+            config.shm_interval = yaml_config["shm_interval"].as<int>();
+        }
+        
+        if (yaml_config["perf_counters"]) {
+            config.perf_counters = yaml_config["perf_counters"].as<bool>();
+        }
+        
+        if (yaml_config["journal_file"]) {
+            config.journal_file = yaml_config["journal_file"].as<std::string>();
+        }
+        
+        if (yaml_config["journal_max_mb"]) {
+            config.journal_max_mb = yaml_config["journal_max_mb"].as<int>();
+        }
+        
+        if (yaml_config["journal_keep"]) {
+            config.journal_keep = yaml_config["journal_keep"].as<int>();
+        }
+        
+        if (yaml_config["journal_fsync"]) {
+            config.journal_fsync = yaml_config["journal_fsync"].as<int>();
+        }
+        
+        if (yaml_config["log_mode"]) {
+            config.log_mode = yaml_config["log_mode"].as<std::string>();
+        }
+        
+        if (yaml_config["log_interval"]) {
+            config.log_interval = yaml_config["log_interval"].as<int>();
+        }
+        
+        if (yaml_config["log_rate"]) {
+            config.log_rate = yaml_config["log_rate"].as<double>();
+        }
+        
+        if (yaml_config["trace_file"]) {
+            config.trace_file = yaml_config["trace_file"].as<std::string>();
+        }
+        
+        if (yaml_config["trace_events"]) {
+            config.trace_events = yaml_config["trace_events"].as<int>();
+        }
+        
         if (yaml_config["invisible_mode"]) {
             config.invisible_mode = yaml_config["invisible_mode"].as<bool>();
         }
@@ -88,11 +257,43 @@ bool ConfigYAML::save(const std::string& filename, const Config& config) {
         out << YAML::Key << "address" << YAML::Value << config.pool_address;
         out << YAML::Key << "port" << YAML::Value << config.pool_port;
         out << YAML::EndMap;
+        
+        if (!config.pools.empty()) {
+            out << YAML::Key << "pools" << YAML::Value << YAML::BeginSeq;
+            for (const auto& pool : config.pools) {
+                out << YAML::BeginMap;
+                out << YAML::Key << "address" << YAML::Value << pool.address;
+                out << YAML::Key << "port" << YAML::Value << pool.port;
+                out << YAML::Key << "weight" << YAML::Value << pool.weight;
+                out << YAML::EndMap;
+            }
+            out << YAML::EndSeq;
+        }
+        out << YAML::Key << "pool_balance" << YAML::Value << config.pool_balance;
+        out << YAML::Key << "pool_cache" << YAML::Value << config.pool_cache;
+        out << YAML::Key << "pool_cache_ttl" << YAML::Value << config.pool_cache_ttl;
         out << YAML::Newline;
         
         out << YAML::Key << "start_diff" << YAML::Value << config.start_diff;
         out << YAML::Key << "threads" << YAML::Value << config.threads;
+        out << YAML::Key << "max_workers" << YAML::Value << config.max_workers;
+        out << YAML::Key << "retire_grace" << YAML::Value << config.retire_grace;
+        out << YAML::Key << "pause_refresh" << YAML::Value << config.pause_refresh;
+        out << YAML::Key << "autoscale" << YAML::Value << config.autoscale;
+        out << YAML::Key << "autoscale_min" << YAML::Value << config.autoscale_min;
+        out << YAML::Key << "autoscale_interval" << YAML::Value << config.autoscale_interval;
+        out << YAML::Key << "autoscale_pressure" << YAML::Value << config.autoscale_pressure;
         out << YAML::Key << "intensity" << YAML::Value << config.intensity;
+        out << YAML::Key << "affinity" << YAML::Value << config.affinity;
+        if (!config.sysfs_root.empty()) {
+            out << YAML::Key << "sysfs_root" << YAML::Value << config.sysfs_root;
+        }
+        out << YAML::Key << "kernel" << YAML::Value << config.kernel;
+        out << YAML::Key << "efficiency_diff" << YAML::Value << config.efficiency_diff;
+        out << YAML::Key << "efficiency_kernel" << YAML::Value << config.efficiency_kernel;
+        out << YAML::Key << "efficiency_weight" << YAML::Value << config.efficiency_weight;
+        out << YAML::Key << "max_hashrate" << YAML::Value << config.max_hashrate;
+        out << YAML::Key << "max_hashrate_thread" << YAML::Value << config.max_hashrate_thread;
         out << YAML::Newline;
         
         out << YAML::Key << "soc_timeout" << YAML::Value << config.soc_timeout;
@@ -101,6 +302,29 @@ bool ConfigYAML::save(const std::string& filename, const Config& config) {
         out << YAML::Key << "max_retries" << YAML::Value << config.max_retries;
         out << YAML::Newline;
         
+        out << YAML::Key << "http_host" << YAML::Value << config.http_host;
+        out << YAML::Key << "http_port" << YAML::Value << config.http_port;
+        out << YAML::Key << "http_control" << YAML::Value << config.http_control;
+        out << YAML::Key << "statsd_host" << YAML::Value << config.statsd_host;
+        out << YAML::Key << "statsd_port" << YAML::Value << config.statsd_port;
+        out << YAML::Key << "statsd_prefix" << YAML::Value << config.statsd_prefix;
+        out << YAML::Key << "statsd_format" << YAML::Value << config.statsd_format;
+        out << YAML::Key << "statsd_mtu" << YAML::Value << config.statsd_mtu;
+        out << YAML::Key << "sample_interval" << YAML::Value << config.sample_interval;
+        out << YAML::Key << "shm_name" << YAML::Value << config.shm_name;
+        out << YAML::Key << "shm_interval" << YAML::Value << config.shm_interval;
+        out << YAML::Key << "perf_counters" << YAML::Value << config.perf_counters;
+        out << YAML::Key << "journal_file" << YAML::Value << config.journal_file;
+        out << YAML::Key << "journal_max_mb" << YAML::Value << config.journal_max_mb;
+        out << YAML::Key << "journal_keep" << YAML::Value << config.journal_keep;
+        out << YAML::Key << "journal_fsync" << YAML::Value << config.journal_fsync;
+        out << YAML::Key << "log_mode" << YAML::Value << config.log_mode;
+        out << YAML::Key << "log_interval" << YAML::Value << config.log_interval;
+        out << YAML::Key << "log_rate" << YAML::Value << config.log_rate;
+        out << YAML::Key << "trace_file" << YAML::Value << config.trace_file;
+        out << YAML::Key << "trace_events" << YAML::Value << config.trace_events;
+        out << YAML::Newline;
+        
         out << YAML::Key << "invisible_mode" << YAML::Value << config.invisible_mode;
         
         out << YAML::EndMap;
@@ -146,24 +370,97 @@ bool ConfigYAML::create_default(const std::string& filename) {
         out << YAML::EndMap;
         out << YAML::Newline;
         
+        out << YAML::Key << "pool_balance" << YAML::Value << "weighted";
+        out << YAML::Comment("Sharding across 'pools' list: weighted or adaptive");
+        out << YAML::Key << "pool_cache" << YAML::Value << "pool_cache.json";
+        out << YAML::Comment("Last picked pool, used for instant startup (empty = off)");
+        out << YAML::Key << "pool_cache_ttl" << YAML::Value << 3600;
+        out << YAML::Newline;
+        
         out << YAML::Key << "start_diff" << YAML::Value << "NET";
-        out << YAML::Comment("Difficulty: LOW, MEDIUM, or NET");
+        out << YAML::Comment("Difficulty: LOW, MEDIUM, NET, or AUTO (adapt per thread)");
         out << YAML::Newline;
         
         out << YAML::Key << "threads" << YAML::Value << 0;
         out << YAML::Comment("Number of threads (0 = auto)");
+        out << YAML::Key << "max_workers" << YAML::Value << 0;
+        out << YAML::Comment("Most workers runtime scaling may start (0 = usable CPUs)");
+        out << YAML::Key << "retire_grace" << YAML::Value << 10;
+        out << YAML::Comment("Seconds a retiring worker may spend finishing its job");
+        out << YAML::Key << "pause_refresh" << YAML::Value << 60;
+        out << YAML::Comment("Seconds paused before workers reconnect for a fresh job (0 = never)");
+        out << YAML::Key << "autoscale" << YAML::Value << false;
+        out << YAML::Comment("Add and retire workers with the load on the host");
+        out << YAML::Key << "autoscale_min" << YAML::Value << 1;
+        out << YAML::Key << "autoscale_interval" << YAML::Value << 10;
+        out << YAML::Key << "autoscale_pressure" << YAML::Value << 10;
+        out << YAML::Comment("CPU pressure (PSI some, %) above which a worker retires");
         out << YAML::Newline;
         
         out << YAML::Key << "intensity" << YAML::Value << 95;
-        out << YAML::Comment("Mining intensity (1-100)");
+        out << YAML::Comment("CPU duty cycle per thread (1-100)");
+        out << YAML::Key << "affinity" << YAML::Value << "scatter";
+        out << YAML::Comment("Worker placement: scatter, compact, physical or none");
+        out << YAML::Key << "kernel" << YAML::Value << "auto";
+        out << YAML::Comment("Digest compare: auto, scalar, avx2, avx512 or neon");
+        out << YAML::Key << "efficiency_diff" << YAML::Value << "";
+        out << YAML::Comment("Hybrid CPUs: E-core starting difficulty (empty = one tier below)");
+        out << YAML::Key << "efficiency_kernel" << YAML::Value << "auto";
+        out << YAML::Key << "efficiency_weight" << YAML::Value << 0;
+        out << YAML::Comment("E-core work share vs a P-core (0 = from cpu_capacity, else 0.5)");
+        out << YAML::Key << "max_hashrate" << YAML::Value << 0;
+        out << YAML::Comment("H/s cap for the whole miner (0 = off)");
+        out << YAML::Key << "max_hashrate_thread" << YAML::Value << 0;
+        out << YAML::Comment("H/s cap per thread (0 = off)");
         out << YAML::Newline;
         
         out << YAML::Key << "soc_timeout" << YAML::Value << 15;
         out << YAML::Key << "report_interval" << YAML::Value << 300;
+        out << YAML::Comment("Seconds between StatsD pushes");
         out << YAML::Key << "retry_delay" << YAML::Value << 5;
         out << YAML::Key << "max_retries" << YAML::Value << 3;
         out << YAML::Newline;
         
+        out << YAML::Key << "http_host" << YAML::Value << "127.0.0.1";
+        out << YAML::Key << "http_port" << YAML::Value << 0;
+        out << YAML::Comment("Prometheus /metrics and JSON /api/summary (0 = off)");
+        out << YAML::Key << "http_control" << YAML::Value << false;
+        out << YAML::Comment("Accept POST /api/workers to change the worker count");
+        out << YAML::Key << "statsd_host" << YAML::Value << "";
+        out << YAML::Comment("StatsD/DogStatsD UDP push target (empty = off)");
+        out << YAML::Key << "statsd_port" << YAML::Value << 8125;
+        out << YAML::Key << "statsd_prefix" << YAML::Value << "duino";
+        out << YAML::Key << "statsd_format" << YAML::Value << "dogstatsd";
+        out << YAML::Comment("dogstatsd (rig/thread tags) or statsd (tags in the name)");
+        out << YAML::Key << "statsd_mtu" << YAML::Value << 1432;
+        out << YAML::Key << "sample_interval" << YAML::Value << 2;
+        out << YAML::Comment("Seconds between CPU usage samples from /proc");
+        out << YAML::Key << "shm_name" << YAML::Value << "";
+        out << YAML::Comment("Shared-memory stats for duino-top, e.g. duino-cpu (empty = off)");
+        out << YAML::Key << "shm_interval" << YAML::Value << 250;
+        out << YAML::Comment("Milliseconds between shared-memory updates");
+        out << YAML::Key << "perf_counters" << YAML::Value << false;
+        out << YAML::Comment("Cycles/hash and IPC per thread from hardware counters");
+        out << YAML::Key << "journal_file" << YAML::Value << "";
+        out << YAML::Comment("Binary journal of every job and share, read with duino-journal (empty = off)");
+        out << YAML::Key << "journal_max_mb" << YAML::Value << 64;
+        out << YAML::Comment("Rotate the journal at this size");
+        out << YAML::Key << "journal_keep" << YAML::Value << 3;
+        out << YAML::Comment("Rotated journal files kept");
+        out << YAML::Key << "journal_fsync" << YAML::Value << 5;
+        out << YAML::Comment("Seconds between journal fsyncs");
+        out << YAML::Key << "log_mode" << YAML::Value << "full";
+        out << YAML::Comment("full (a line per share) or summary (one share line per log_interval)");
+        out << YAML::Key << "log_interval" << YAML::Value << 10;
+        out << YAML::Comment("Seconds between share summaries and rate-limit reports");
+        out << YAML::Key << "log_rate" << YAML::Value << 0;
+        out << YAML::Comment("Max job/share/diff lines/s per class (0 = unlimited); other lines always pass");
+        out << YAML::Key << "trace_file" << YAML::Value << "";
+        out << YAML::Comment("Worker timeline in Chrome Trace JSON, dumped on exit and SIGHUP (empty = off)");
+        out << YAML::Key << "trace_events" << YAML::Value << 16384;
+        out << YAML::Comment("Trace events kept per thread");
+        out << YAML::Newline;
+        
         out << YAML::Key << "invisible_mode" << YAML::Value << false;
         out << YAML::Comment("Hide process from htop/btop");
         
@@ -0,0 +1,248 @@
+#include "../include/cpu_limits.h"
+#include "../include/topology.h"
+#include <fstream>
+#include <sstream>
+#include <algorithm>
+#include <iterator>
+#include <iomanip>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <thread>
+#include <cerrno>
+#include <sched.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+static bool read_line(const std::string& path, std::string& line) {
+    std::ifstream file(path);
+    return file.is_open() && std::getline(file, line);
+}
+
+static bool is_dir(const std::string& path) {
+    struct stat st;
+    return stat(path.c_str(), &st) == 0 && S_ISDIR(st.st_mode);
+}
+
+static bool has_option(const std::string& list, const char* option, char separator = ',') {
+    std::stringstream ss(list);
+    std::string item;
+    while (std::getline(ss, item, separator)) {
+        if (item == option) return true;
+    }
+    return false;
+}
+
+// One cgroup controller: where its hierarchy is mounted, which part of the
+// hierarchy the mount shows, and the miner's cgroup in it
+struct CgroupMount {
+    std::string mount_point;
+    std::string mount_root;
+    std::string path;
+
+    // The mount shows mount_root and below; inside a container that is
+    // usually the container's own cgroup, so path is cut down to it
+    std::string dir() const {
+        std::string rel = path;
+        if (mount_root != "/" && rel.compare(0, mount_root.size(), mount_root) == 0) {
+            rel = rel.substr(mount_root.size());
+        }
+        std::string full = mount_point + (rel == "/" ? "" : rel);
+        return is_dir(full) ? full : mount_point;
+    }
+};
+
+// controller empty = the v2 unified hierarchy
+static bool find_mount(const std::string& root, const char* controller, CgroupMount& mount) {
+    std::ifstream mountinfo(root + "/proc/self/mountinfo");
+    std::string line;
+    while (std::getline(mountinfo, line)) {
+        // id parent major:minor root mount-point options [tags] - type source super-options
+        size_t sep = line.find(" - ");
+        if (sep == std::string::npos) continue;
+        std::istringstream head(line.substr(0, sep));
+        std::istringstream tail(line.substr(sep + 3));
+        std::string id, parent, dev, mount_root, mount_point, type, source, options;
+        if (!(head >> id >> parent >> dev >> mount_root >> mount_point)) continue;
+        if (!(tail >> type >> source >> options)) continue;
+        if (controller[0] == '\0' ? type != "cgroup2"
+                                  : type != "cgroup" || !has_option(options, controller)) {
+            continue;
+        }
+        mount.mount_point = root + mount_point;
+        mount.mount_root = mount_root;
+        break;
+    }
+    if (mount.mount_point.empty()) return false;
+
+    // hierarchy-id:controller-list:path, "0::path" for v2
+    std::ifstream cgroup(root + "/proc/self/cgroup");
+    while (std::getline(cgroup, line)) {
+        size_t first = line.find(':');
+        size_t second = line.find(':', first + 1);
+        if (first == std::string::npos || second == std::string::npos) continue;
+        std::string controllers = line.substr(first + 1, second - first - 1);
+        if (controller[0] == '\0' ? controllers.empty() : has_option(controllers, controller)) {
+            mount.path = line.substr(second + 1);
+            return true;
+        }
+    }
+    mount.path = "/";
+    return true;
+}
+
+// The tightest quota from dir up to the top of the mount; parents limit
+// their children too
+static double read_quota(const std::string& dir, const std::string& top, int version) {
+    double quota = 0.0;
+    for (std::string d = dir; ; ) {
+        double limit = 0.0;
+        std::string line;
+        if (version == 2) {
+            // "max 100000" or "<quota> <period>"
+            long long q, period;
+            if (read_line(d + "/cpu.max", line) &&
+                sscanf(line.c_str(), "%lld %lld", &q, &period) == 2 && q > 0 && period > 0) {
+                limit = (double)q / period;
+            }
+        } else {
+            std::string period_line;
+            if (read_line(d + "/cpu.cfs_quota_us", line) &&
+                read_line(d + "/cpu.cfs_period_us", period_line)) {
+                long long q = atoll(line.c_str());
+                long long period = atoll(period_line.c_str());
+                if (q > 0 && period > 0) limit = (double)q / period;
+            }
+        }
+        if (limit > 0 && (quota == 0 || limit < quota)) quota = limit;
+
+        if (d.size() <= top.size()) break;
+        size_t slash = d.rfind('/');
+        if (slash == std::string::npos || slash < top.size()) break;
+        d = d.substr(0, slash);
+    }
+    return quota;
+}
+
+bool CpuLimits::load(const std::string& root) {
+    allowed.clear();
+    quota = 0.0;
+    cgroup_version = 0;
+    cpu_dir.clear();
+
+#ifdef __linux__
+    // The kernel rejects a mask smaller than its own CPU count, so grow
+    // it until it fits
+    for (int count = std::max<long>(CPU_SETSIZE, sysconf(_SC_NPROCESSORS_CONF));
+         root.empty() && count <= (1 << 20); count *= 2) {
+        cpu_set_t* set = CPU_ALLOC(count);
+        if (!set) break;
+        size_t size = CPU_ALLOC_SIZE(count);
+        CPU_ZERO_S(size, set);
+        int result = sched_getaffinity(0, size, set);
+        if (result == 0) {
+            for (int cpu = 0; cpu < count; cpu++) {
+                if (CPU_ISSET_S(cpu, size, set)) allowed.push_back(cpu);
+            }
+        }
+        CPU_FREE(set);
+        if (result == 0 || errno != EINVAL) break;
+    }
+#endif
+
+    std::vector<int> cpuset;
+    std::string line;
+    // A v2 hierarchy mounted next to v1 ones ("hybrid") only counts when
+    // the cpu controller is enabled in it
+    CgroupMount mount;
+    bool unified = find_mount(root, "", mount) &&
+                   read_line(mount.mount_point + "/cgroup.controllers", line) &&
+                   has_option(line, "cpu", ' ');
+    if (unified) {
+        cgroup_version = 2;
+        cpu_dir = mount.dir();
+        quota = read_quota(cpu_dir, mount.mount_point, 2);
+        if (read_line(cpu_dir + "/cpuset.cpus.effective", line)) {
+            cpuset = Topology::parse_list(line);
+        }
+    } else if (find_mount(root, "cpu", mount)) {
+        cgroup_version = 1;
+        cpu_dir = mount.dir();
+        quota = read_quota(cpu_dir, mount.mount_point, 1);
+        CgroupMount cpuset_mount;
+        if (find_mount(root, "cpuset", cpuset_mount) &&
+            read_line(cpuset_mount.dir() + "/cpuset.effective_cpus", line)) {
+            cpuset = Topology::parse_list(line);
+        }
+    }
+
+    // The affinity mask is normally within the cpuset already; the
+    // intersection also covers a fake root, where only the cpuset is known
+    if (allowed.empty()) {
+        allowed = cpuset;
+    } else if (!cpuset.empty()) {
+        std::vector<int> both;
+        std::set_intersection(allowed.begin(), allowed.end(), cpuset.begin(), cpuset.end(),
+                              std::back_inserter(both));
+        if (!both.empty()) allowed = both;
+    }
+    return cgroup_version != 0;
+}
+
+int CpuLimits::usable_cpus() const {
+    int cpus = allowed.empty() ? (int)std::thread::hardware_concurrency() : (int)allowed.size();
+    if (quota > 0) {
+        // A worker never sleeps, so a fractional CPU of quota left over
+        // would only be spent throttled
+        cpus = std::min(cpus, (int)std::floor(quota + 1e-6));
+    }
+    return std::max(cpus, 1);
+}
+
+bool CpuLimits::allows(int cpu) const {
+    return allowed.empty() || std::binary_search(allowed.begin(), allowed.end(), cpu);
+}
+
+std::string CpuLimits::describe() const {
+    std::ostringstream ss;
+    ss << usable_cpus() << " usable";
+    if (!allowed.empty()) ss << ", CPUs " << Topology::format_list(allowed);
+    if (quota > 0) {
+        ss << ", cgroup v" << cgroup_version << " quota "
+           << std::fixed << std::setprecision(2) << quota << " CPUs";
+    }
+    return ss.str();
+}
+
+int CpuLimits::default_threads(const std::string& root) {
+    CpuLimits limits;
+    limits.load(root);
+    return limits.usable_cpus();
+}
+
+// v2: nr_periods, nr_throttled, throttled_usec
+// v1: nr_periods, nr_throttled, throttled_time (nanoseconds)
+bool parse_cpu_stat(const char* text, CpuThrottle& throttle) {
+    bool found = false;
+    const char* p = text;
+    while (*p) {
+        char key[32];
+        unsigned long long value;
+        if (sscanf(p, "%31s %llu", key, &value) == 2) {
+            if (strcmp(key, "nr_periods") == 0) {
+                throttle.periods = value;
+                found = true;
+            } else if (strcmp(key, "nr_throttled") == 0) {
+                throttle.throttled = value;
+            } else if (strcmp(key, "throttled_usec") == 0) {
+                throttle.throttled_seconds = value / 1e6;
+            } else if (strcmp(key, "throttled_time") == 0) {
+                throttle.throttled_seconds = value / 1e9;
+            }
+        }
+        const char* next = strchr(p, '\n');
+        if (!next) break;
+        p = next + 1;
+    }
+    return found;
+}
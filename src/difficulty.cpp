@@ -0,0 +1,78 @@
+#include "../include/difficulty.h"
+#include <algorithm>
+#include <cctype>
+
+static const double EWMA_ALPHA = 0.25;
+
+DifficultyController::DifficultyController(const std::string& start_diff)
+    : adaptive(start_diff == "AUTO"), tier(DIFF_NET) {
+    if (start_diff == "LOW") tier = DIFF_LOW;
+    else if (start_diff == "MEDIUM" || adaptive) tier = DIFF_MEDIUM;
+}
+
+const char* DifficultyController::tier_name(int tier) {
+    switch (tier) {
+        case DIFF_LOW: return "LOW";
+        case DIFF_MEDIUM: return "MEDIUM";
+        default: return "NET";
+    }
+}
+
+void DifficultyController::change(int delta, const std::string& reason) {
+    tier += delta;
+    jobs_since_change = 0;
+    too_easy = false;
+    ewma_solve = 0.0;
+    ewma_useful = 1.0;
+    if (delta < 0) {
+        up_blocked = DIFF_BACKOFF_JOBS;
+    }
+    last_reason = reason;
+}
+
+bool DifficultyController::record(double solve_seconds, int job_rtt_ms, int submit_rtt_ms,
+                                  bool accepted, const std::string& reject_reason) {
+    double overhead = (job_rtt_ms + submit_rtt_ms) / 1000.0;
+    double cycle = solve_seconds + overhead;
+    double useful = cycle > 0.0 ? solve_seconds / cycle : 1.0;
+
+    if (jobs_since_change == 0) {
+        ewma_solve = solve_seconds;
+        ewma_useful = useful;
+    } else {
+        ewma_solve += EWMA_ALPHA * (solve_seconds - ewma_solve);
+        ewma_useful += EWMA_ALPHA * (useful - ewma_useful);
+    }
+    ewma_rtt = ewma_rtt == 0.0 ? overhead * 1000.0
+                               : ewma_rtt + EWMA_ALPHA * (overhead * 1000.0 - ewma_rtt);
+    jobs_since_change++;
+    if (up_blocked > 0) up_blocked--;
+
+    if (!adaptive) return false;
+
+    // The pool rejects shares that come in too quickly for the tier
+    if (!accepted) {
+        std::string reason = reject_reason;
+        std::transform(reason.begin(), reason.end(), reason.begin(), ::tolower);
+        if (reason.find("fast") != std::string::npos ||
+            reason.find("diff") != std::string::npos) {
+            too_easy = true;
+        }
+    }
+
+    if (jobs_since_change < DIFF_MIN_JOBS) return false;
+
+    if (tier < DIFF_NET && too_easy) {
+        change(+1, "rejected as too easy");
+        return true;
+    }
+    if (tier < DIFF_NET && up_blocked == 0 && ewma_useful < DIFF_MIN_USEFUL) {
+        change(+1, "RTT-bound");
+        return true;
+    }
+    if (tier > DIFF_LOW && ewma_solve > DIFF_MAX_SOLVE) {
+        change(-1, "shares too slow");
+        return true;
+    }
+    return false;
+}
@@ -44,6 +44,12 @@ void Hasher::ducos1_hash(const std::string& input, uint8_t output[20]) {
          input.length(), output);
 }
 
+// The hash itself is OpenSSL's SHA1 (which picks SHA-NI/AVX2/NEON at
+// runtime); only the digest compare is ours and it is the scalar one
+const char* Hasher::kernel_name() {
+    return "openssl-sha1";
+}
+
 #if defined(USE_AVX2)
 bool Hasher::ducos1_compare_avx2(const uint8_t hash1[20], const uint8_t hash2[20]) {
     alignas(32) uint8_t a_buf[32] = {0};
@@ -127,6 +133,25 @@ bool Hasher::ducos1_compare(const uint8_t hash1[20], const uint8_t hash2[20]) {
     return memcmp(hash1, hash2, 20) == 0;
 }
 
+bool Hasher::ducos1_compare_scalar(const uint8_t hash1[20], const uint8_t hash2[20]) {
+    return memcmp(hash1, hash2, 20) == 0;
+}
+
+Hasher::CompareKernel Hasher::compare_kernel(const std::string& name) {
+    if (name == "auto") return ducos1_compare;
+    if (name == "scalar") return ducos1_compare_scalar;
+#if defined(USE_AVX512)
+    if (name == "avx512" && check_avx512_support()) return ducos1_compare_avx512;
+#endif
+#if defined(USE_AVX2)
+    if (name == "avx2" && check_avx2_support()) return ducos1_compare_avx2;
+#endif
+#if defined(USE_ARM_NEON)
+    if (name == "neon" && check_neon_support()) return ducos1_compare_neon;
+#endif
+    return nullptr;
+}
+
 std::string Hasher::bytes_to_hex(const uint8_t* bytes, size_t len) {
     std::stringstream ss;
     ss << std::hex << std::setfill('0');
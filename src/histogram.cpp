@@ -0,0 +1,59 @@
+#include "../include/histogram.h"
+
+uint64_t LatencyHistogram::bucket_floor(int idx) {
+    if (idx < HIST_SUB) return idx;
+    int exp = idx / HIST_SUB - 1 + HIST_SUB_BITS;
+    int mantissa = idx % HIST_SUB;
+    return (uint64_t)(HIST_SUB + mantissa) << (exp - HIST_SUB_BITS);
+}
+
+HistogramSummary LatencyHistogram::summary() const {
+    uint32_t counts[HIST_BUCKETS];
+    for (int i = 0; i < HIST_BUCKETS; i++) {
+        counts[i] = buckets[i].load(std::memory_order_relaxed);
+    }
+    return summarize(counts, total_us.load(std::memory_order_relaxed),
+                     max_us.load(std::memory_order_relaxed));
+}
+
+HistogramSummary LatencyHistogram::take() {
+    uint32_t counts[HIST_BUCKETS];
+    for (int i = 0; i < HIST_BUCKETS; i++) {
+        counts[i] = buckets[i].exchange(0, std::memory_order_relaxed);
+    }
+    return summarize(counts, total_us.exchange(0, std::memory_order_relaxed),
+                     max_us.exchange(0, std::memory_order_relaxed));
+}
+
+HistogramSummary LatencyHistogram::summarize(const uint32_t* counts, uint64_t total,
+                                             uint64_t max) {
+    uint64_t count = 0;
+    for (int i = 0; i < HIST_BUCKETS; i++) {
+        count += counts[i];
+    }
+
+    HistogramSummary s = {count, 0.0, 0.0, 0.0, 0.0, max / 1000.0};
+    if (count == 0) return s;
+
+    s.mean_ms = total / 1000.0 / count;
+
+    // Report the middle of the bucket holding each percentile
+    auto value_at = [&](double fraction) {
+        uint64_t rank = (uint64_t)(fraction * (count - 1)) + 1;
+        uint64_t seen = 0;
+        for (int i = 0; i < HIST_BUCKETS; i++) {
+            seen += counts[i];
+            if (seen >= rank) {
+                double lo = bucket_floor(i);
+                double hi = i + 1 < HIST_BUCKETS ? bucket_floor(i + 1) : lo;
+                return (lo + hi) / 2.0 / 1000.0;
+            }
+        }
+        return s.max_ms;
+    };
+
+    s.p50_ms = value_at(0.50);
+    s.p90_ms = value_at(0.90);
+    s.p99_ms = value_at(0.99);
+    return s;
+}
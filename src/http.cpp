@@ -1,56 +1,459 @@
 #include "../include/http_client.h"
 #include "../include/config.h"
 #include "../include/logger.h"
-#include <curl/curl.h>
+#include "../include/network.h"
 #include <sstream>
+#include <mutex>
+#include <map>
+#include <memory>
+#include <algorithm>
+#include <cstring>
+#include <chrono>
+#include <poll.h>
+#include <fcntl.h>
+
+#ifdef USE_CURL
+#include <curl/curl.h>
+#else
+#include <openssl/ssl.h>
+#include <openssl/err.h>
+#endif
+
+#define HTTP_TIMEOUT 10
+#define HTTP_MAX_REDIRECTS 5
+
+#ifdef USE_CURL
 
 static size_t write_callback(void* contents, size_t size, size_t nmemb, void* userp) {
     ((std::string*)userp)->append((char*)contents, size * nmemb);
     return size * nmemb;
 }
 
+static std::mutex curl_mutex;
+static CURL* curl_handle = nullptr;
+
 std::string HttpClient::get(const std::string& url) {
-    CURL* curl;
-    CURLcode res;
+    std::lock_guard<std::mutex> lock(curl_mutex);
     std::string response;
-    
-    curl_global_init(CURL_GLOBAL_DEFAULT);
-    curl = curl_easy_init();
-    
-    if (!curl) {
-        Logger::error("Failed to initialize CURL");
-        return "";
+
+    // One global init and one reused easy handle, so repeated calls share
+    // curl's connection cache instead of paying a fresh handshake each time
+    if (!curl_handle) {
+        curl_global_init(CURL_GLOBAL_DEFAULT);
+        curl_handle = curl_easy_init();
+        if (!curl_handle) {
+            Logger::error("Failed to initialize CURL");
+            return "";
+        }
     }
-    
+
+    CURL* curl = curl_handle;
     curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
     curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, write_callback);
     curl_easy_setopt(curl, CURLOPT_WRITEDATA, &response);
     curl_easy_setopt(curl, CURLOPT_USERAGENT, "duino-cpu/" VERSION);
-    curl_easy_setopt(curl, CURLOPT_TIMEOUT, 10L);
+    curl_easy_setopt(curl, CURLOPT_TIMEOUT, (long)HTTP_TIMEOUT);
     curl_easy_setopt(curl, CURLOPT_FOLLOWLOCATION, 1L);
     curl_easy_setopt(curl, CURLOPT_SSL_VERIFYPEER, 0L);
     curl_easy_setopt(curl, CURLOPT_SSL_VERIFYHOST, 0L);
-    
-    res = curl_easy_perform(curl);
-    
+
+    CURLcode res = curl_easy_perform(curl);
+
     if (res != CURLE_OK) {
         Logger::error("CURL error: " + std::string(curl_easy_strerror(res)));
-        curl_easy_cleanup(curl);
-        curl_global_cleanup();
         return "";
     }
-    
-    curl_easy_cleanup(curl);
-    curl_global_cleanup();
-    
+
     return response;
 }
 
-bool HttpClient::parse_url(const std::string& url, std::string& host, 
-                           std::string& path, int& port, bool& use_ssl) {
-    return true;
+void HttpClient::close_all() {
+    std::lock_guard<std::mutex> lock(curl_mutex);
+    if (curl_handle) {
+        curl_easy_cleanup(curl_handle);
+        curl_handle = nullptr;
+        curl_global_cleanup();
+    }
 }
 
-std::string HttpClient::https_get(const std::string& host, const std::string& path, int port) {
+#else
+
+namespace {
+
+struct HttpConnection {
+    SocketClient socket;
+    SSL* ssl = nullptr;
+    std::string buffer;     // bytes read past the current position
+
+    ~HttpConnection() {
+        if (ssl) {
+            SSL_shutdown(ssl);
+            SSL_free(ssl);
+        }
+    }
+
+    bool write(const std::string& data) {
+        if (!ssl) {
+            return socket.send_raw(data.c_str(), data.length());
+        }
+        size_t written = 0;
+        while (written < data.length()) {
+            int n = SSL_write(ssl, data.c_str() + written, data.length() - written);
+            if (n <= 0) return false;
+            written += n;
+        }
+        return true;
+    }
+
+    // Appends more bytes to buffer; false on timeout, error or EOF
+    bool fill() {
+        char chunk[8192];
+        if (!ssl) {
+            ssize_t n = socket.receive_raw(chunk, sizeof(chunk), HTTP_TIMEOUT);
+            if (n <= 0) return false;
+            buffer.append(chunk, n);
+            return true;
+        }
+
+        while (true) {
+            if (SSL_pending(ssl) == 0) {
+                struct pollfd pfd;
+                pfd.fd = socket.get_fd();
+                pfd.events = POLLIN;
+                if (poll(&pfd, 1, HTTP_TIMEOUT * 1000) <= 0) return false;
+            }
+            int n = SSL_read(ssl, chunk, sizeof(chunk));
+            if (n > 0) {
+                buffer.append(chunk, n);
+                return true;
+            }
+            int err = SSL_get_error(ssl, n);
+            if (err != SSL_ERROR_WANT_READ && err != SSL_ERROR_WANT_WRITE) {
+                return false;
+            }
+        }
+    }
+
+    bool read_line(std::string& line) {
+        size_t pos;
+        while ((pos = buffer.find("\r\n")) == std::string::npos) {
+            if (!fill()) return false;
+        }
+        line = buffer.substr(0, pos);
+        buffer.erase(0, pos + 2);
+        return true;
+    }
+
+    bool read_exact(size_t len, std::string& out) {
+        while (buffer.length() < len) {
+            if (!fill()) return false;
+        }
+        out.append(buffer, 0, len);
+        buffer.erase(0, len);
+        return true;
+    }
+
+    void read_to_close(std::string& out) {
+        while (fill()) {}
+        out += buffer;
+        buffer.clear();
+    }
+};
+
+std::mutex idle_mutex;
+std::map<std::string, std::unique_ptr<HttpConnection>> idle_connections;
+
+SSL_CTX* get_ssl_ctx() {
+    static std::once_flag once;
+    static SSL_CTX* ctx = nullptr;
+    std::call_once(once, []() {
+        ctx = SSL_CTX_new(TLS_client_method());
+        if (ctx) {
+            // Same policy as the previous libcurl setup (VERIFYPEER off)
+            SSL_CTX_set_verify(ctx, SSL_VERIFY_NONE, nullptr);
+            SSL_CTX_set_min_proto_version(ctx, TLS1_2_VERSION);
+        }
+    });
+    return ctx;
+}
+
+// SSL_connect on a non-blocking socket, polled against HTTP_TIMEOUT: the
+// TCP timeouts do not cover a peer that accepts and then stalls the
+// handshake
+bool handshake(SSL* ssl, int fd) {
+    int flags = fcntl(fd, F_GETFL, 0);
+    fcntl(fd, F_SETFL, flags | O_NONBLOCK);
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(HTTP_TIMEOUT);
+
+    bool ok = false;
+    while (true) {
+        int result = SSL_connect(ssl);
+        if (result == 1) {
+            ok = true;
+            break;
+        }
+        int err = SSL_get_error(ssl, result);
+        if (err != SSL_ERROR_WANT_READ && err != SSL_ERROR_WANT_WRITE) break;
+
+        int wait_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+            deadline - std::chrono::steady_clock::now()).count();
+        struct pollfd pfd;
+        pfd.fd = fd;
+        pfd.events = err == SSL_ERROR_WANT_READ ? POLLIN : POLLOUT;
+        if (wait_ms <= 0 || poll(&pfd, 1, wait_ms) <= 0) {
+            Logger::error("TLS handshake timed out");
+            fcntl(fd, F_SETFL, flags);
+            return false;
+        }
+    }
+    fcntl(fd, F_SETFL, flags);
+
+    if (!ok) {
+        char err[256];
+        ERR_error_string_n(ERR_get_error(), err, sizeof(err));
+        Logger::error("TLS handshake failed: " + std::string(err));
+    }
+    return ok;
+}
+
+std::unique_ptr<HttpConnection> open_connection(const std::string& host, int port,
+                                                bool use_ssl) {
+    auto conn = std::make_unique<HttpConnection>();
+    if (!conn->socket.connect(host, port, HTTP_TIMEOUT)) {
+        Logger::error("HTTP connect failed: " + host + ":" + std::to_string(port));
+        return nullptr;
+    }
+
+    if (use_ssl) {
+        SSL_CTX* ctx = get_ssl_ctx();
+        if (!ctx) {
+            Logger::error("Failed to initialize TLS");
+            return nullptr;
+        }
+        conn->ssl = SSL_new(ctx);
+        SSL_set_fd(conn->ssl, conn->socket.get_fd());
+        SSL_set_tlsext_host_name(conn->ssl, host.c_str());
+        if (!handshake(conn->ssl, conn->socket.get_fd())) {
+            return nullptr;
+        }
+    }
+    return conn;
+}
+
+std::string to_lower(std::string s) {
+    std::transform(s.begin(), s.end(), s.begin(), ::tolower);
+    return s;
+}
+
+}
+
+std::string HttpClient::get(const std::string& url) {
+    std::string current = url;
+
+    for (int redirects = 0; redirects <= HTTP_MAX_REDIRECTS; redirects++) {
+        std::string host, path, location;
+        int port;
+        bool use_ssl;
+
+        if (!parse_url(current, host, path, port, use_ssl)) {
+            Logger::error("Invalid URL: " + current);
+            return "";
+        }
+
+        std::string body = https_get(host, path, port, use_ssl, location);
+        if (location.empty()) {
+            return body;
+        }
+
+        if (location[0] == '/') {
+            // parse_url strips the brackets of an IPv6 literal; put them back
+            std::string authority = host.find(':') != std::string::npos ?
+                "[" + host + "]" : host;
+            location = (use_ssl ? "https://" : "http://") + authority + ":" +
+                       std::to_string(port) + location;
+        }
+        current = location;
+    }
+
+    Logger::error("Too many HTTP redirects: " + url);
+    return "";
+}
+
+void HttpClient::close_all() {
+    std::lock_guard<std::mutex> lock(idle_mutex);
+    idle_connections.clear();
+}
+
+std::string HttpClient::https_get(const std::string& host, const std::string& path,
+                                  int port, bool use_ssl, std::string& location) {
+    std::string key = host + ":" + std::to_string(port) + (use_ssl ? ":tls" : "");
+
+    std::stringstream request;
+    request << "GET " << path << " HTTP/1.1\r\n"
+            << "Host: " << host;
+    if (port != (use_ssl ? 443 : 80)) {
+        request << ":" << port;
+    }
+    request << "\r\n"
+            << "User-Agent: duino-cpu/" VERSION "\r\n"
+            << "Accept: */*\r\n"
+            << "Connection: keep-alive\r\n\r\n";
+
+    // A kept-alive connection may have been closed by the server meanwhile;
+    // in that case retry once on a fresh one.
+    for (int attempt = 0; attempt < 2; attempt++) {
+        std::unique_ptr<HttpConnection> conn;
+        {
+            std::lock_guard<std::mutex> lock(idle_mutex);
+            auto it = idle_connections.find(key);
+            if (it != idle_connections.end()) {
+                conn = std::move(it->second);
+                idle_connections.erase(it);
+            }
+        }
+        bool reused = conn != nullptr;
+
+        if (!conn) {
+            conn = open_connection(host, port, use_ssl);
+            if (!conn) return "";
+        }
+
+        std::string status_line;
+        if (!conn->write(request.str()) || !conn->read_line(status_line)) {
+            if (reused) continue;
+            Logger::error("HTTP request failed: " + host);
+            return "";
+        }
+
+        // HTTP/1.1 200 OK
+        int status = 0;
+        size_t sp = status_line.find(' ');
+        if (status_line.compare(0, 5, "HTTP/") != 0 || sp == std::string::npos) {
+            Logger::error("Malformed HTTP response from " + host);
+            return "";
+        }
+        status = atoi(status_line.c_str() + sp + 1);
+
+        // 1xx interim responses are headers only and precede the real one
+        std::string line;
+        while (status >= 100 && status < 200) {
+            while (conn->read_line(line) && !line.empty()) {}
+            if (!conn->read_line(status_line)) {
+                Logger::error("HTTP request failed: " + host);
+                return "";
+            }
+            sp = status_line.find(' ');
+            if (status_line.compare(0, 5, "HTTP/") != 0 || sp == std::string::npos) {
+                Logger::error("Malformed HTTP response from " + host);
+                return "";
+            }
+            status = atoi(status_line.c_str() + sp + 1);
+        }
+
+        long content_length = -1;
+        bool chunked = false;
+        bool keep_alive = status_line.compare(0, 8, "HTTP/1.1") == 0;
+
+        while (conn->read_line(line) && !line.empty()) {
+            size_t colon = line.find(':');
+            if (colon == std::string::npos) continue;
+            std::string name = to_lower(line.substr(0, colon));
+            std::string value = line.substr(colon + 1);
+            value.erase(0, value.find_first_not_of(" \t"));
+
+            if (name == "content-length") {
+                content_length = atol(value.c_str());
+            } else if (name == "transfer-encoding") {
+                chunked = to_lower(value).find("chunked") != std::string::npos;
+            } else if (name == "connection") {
+                std::string v = to_lower(value);
+                if (v.find("close") != std::string::npos) keep_alive = false;
+                if (v.find("keep-alive") != std::string::npos) keep_alive = true;
+            } else if (name == "location") {
+                location = value;
+            }
+        }
+
+        std::string body;
+        bool complete = true;
+        // No body by definition, whatever the headers say; reading to close
+        // would stall a kept-alive connection for HTTP_TIMEOUT
+        if (status == 204 || status == 304) {
+            chunked = false;
+            content_length = 0;
+        }
+        if (chunked) {
+            while (true) {
+                std::string size_line;
+                if (!conn->read_line(size_line)) { complete = false; break; }
+                size_t chunk_size = strtoul(size_line.c_str(), nullptr, 16);
+                if (chunk_size == 0) {
+                    while (conn->read_line(line) && !line.empty()) {}
+                    break;
+                }
+                if (!conn->read_exact(chunk_size, body) || !conn->read_line(line)) {
+                    complete = false;
+                    break;
+                }
+            }
+        } else if (content_length >= 0) {
+            complete = conn->read_exact(content_length, body);
+        } else {
+            conn->read_to_close(body);
+            keep_alive = false;
+        }
+
+        if (complete && keep_alive && conn->socket.is_connected()) {
+            std::lock_guard<std::mutex> lock(idle_mutex);
+            idle_connections[key] = std::move(conn);
+        }
+
+        if (status < 300 || status >= 400) {
+            location.clear();
+        }
+        if (status >= 400) {
+            Logger::error("HTTP error " + std::to_string(status) + " from " + host);
+            return "";
+        }
+        return body;
+    }
+
     return "";
-}
\ No newline at end of file
+}
+
+#endif
+
+bool HttpClient::parse_url(const std::string& url, std::string& host,
+                           std::string& path, int& port, bool& use_ssl) {
+    size_t pos;
+    if (url.compare(0, 8, "https://") == 0) {
+        use_ssl = true;
+        port = 443;
+        pos = 8;
+    } else if (url.compare(0, 7, "http://") == 0) {
+        use_ssl = false;
+        port = 80;
+        pos = 7;
+    } else {
+        return false;
+    }
+
+    size_t path_start = url.find('/', pos);
+    std::string authority = url.substr(pos, path_start == std::string::npos ?
+                                       std::string::npos : path_start - pos);
+    path = path_start == std::string::npos ? "/" : url.substr(path_start);
+
+    size_t colon = authority.rfind(':');
+    size_t bracket = authority.rfind(']');
+    if (colon != std::string::npos &&
+        (bracket == std::string::npos || colon > bracket)) {
+        port = atoi(authority.c_str() + colon + 1);
+        authority = authority.substr(0, colon);
+    }
+    if (authority.size() > 2 && authority.front() == '[' && authority.back() == ']') {
+        authority = authority.substr(1, authority.size() - 2);
+    }
+    host = authority;
+
+    return !host.empty() && port > 0 && port < 65536;
+}
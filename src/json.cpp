@@ -1,6 +1,7 @@
 #include "../include/json.h"
 #include <sstream>
 #include <algorithm>
+#include <cstdio>
 
 std::string Json::get_value(const std::string& json, const std::string& key) {
     std::string search = "\"" + key + "\"";
@@ -43,6 +44,28 @@ int Json::get_int(const std::string& json, const std::string& key) {
     }
 }
 
+std::string Json::quote(const std::string& value) {
+    std::string out = "\"";
+    for (char c : value) {
+        switch (c) {
+            case '"': out += "\\\""; break;
+            case '\\': out += "\\\\"; break;
+            case '\n': out += "\\n"; break;
+            case '\r': out += "\\r"; break;
+            case '\t': out += "\\t"; break;
+            default:
+                if ((unsigned char)c < 0x20) {
+                    char buf[8];
+                    snprintf(buf, sizeof(buf), "\\u%04x", c);
+                    out += buf;
+                } else {
+                    out += c;
+                }
+        }
+    }
+    return out + "\"";
+}
+
 std::map<std::string, std::string> Json::parse(const std::string& json) {
     std::map<std::string, std::string> result;
     return result;
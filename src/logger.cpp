@@ -11,10 +11,22 @@
 #include <cmath>
 #include <atomic>  
 #include <fstream>
+#include <memory>
+#include <algorithm>
+#include <climits>
+#include <condition_variable>
+#include <cstdlib>
+#include <time.h>
 #include <sys/sysinfo.h>
+#include "../include/mpsc_queue.h"
+
+#define LOG_QUEUE_SIZE 4096
+#define LOG_BATCH 256
+#define LOG_IDLE_WAIT_MS 100
+#define LOG_BURST_SECONDS 2
 
 static bool enabled = true;
-static std::mutex log_mutex;
+static std::mutex log_mutex;    // serializes rendering and writes to stdout
 
 // Color codes - XMRig style
 #define RESET         "\033[0m"
@@ -48,13 +60,346 @@ static std::mutex log_mutex;
 #define TAG_CPU       BG_CYAN BLACK "  cpu   " RESET         
 #define TAG_MINER     BG_MAGENTA WHITE " miner  " RESET       
 
-static std::string get_timestamp() {
-    auto now = std::chrono::system_clock::now();
-    auto time = std::chrono::system_clock::to_time_t(now);
-    
-    std::stringstream ss;
-    ss << GRAY << "[" << std::put_time(std::localtime(&time), "%Y-%m-%d") << "]" << RESET;
-    return ss.str();
+enum RecordKind : uint8_t { RECORD_TEXT, RECORD_SHARE };
+enum ShareVerdict : uint8_t { VERDICT_ACCEPT, VERDICT_REJECT, VERDICT_BLOCK };
+
+// One queued log entry. Share results are the hot path, so they carry raw
+// fields and are formatted by the writer; everything else is rare and
+// arrives as finished text.
+struct LogRecord {
+    RecordKind kind = RECORD_TEXT;
+    bool stamped = false;       // prefix with the timestamp
+    time_t time = 0;
+    uint8_t verdict = VERDICT_ACCEPT;
+    unsigned long accepted = 0;
+    unsigned long rejected = 0;
+    double seconds = 0.0;
+    int difficulty = 0;
+    int ping = 0;
+    std::string text;
+};
+
+// Rate-limited message classes, the ones that scale with the share rate.
+// Errors, BLOCK, info and warnings are never limited; the interactive views
+// ('s', speed) are not either.
+enum LogCategory { CAT_JOB, CAT_SHARE, CAT_DIFF, CAT_COUNT };
+static const char* category_names[CAT_COUNT] = {"job", "share", "diff"};
+
+// Token bucket in GCRA form: the bucket is the "theoretical arrival time"
+// of the next line, refilled at one token per interval_ns and holding up to
+// burst_ns worth. Taking a token is a single CAS.
+struct TokenBucket {
+    std::atomic<int64_t> tat{0};
+    std::atomic<unsigned long> suppressed{0};
+};
+
+static TokenBucket token_buckets[CAT_COUNT];
+static int64_t bucket_interval_ns = 0;  // 0 = unlimited
+static int64_t bucket_burst_ns = 0;
+
+// Accepted/rejected shares folded into one line per summary interval
+struct ShareWindow {
+    std::atomic<unsigned long> accepted{0};
+    std::atomic<unsigned long> rejected{0};
+    std::atomic<int> first_thread{INT_MAX};
+    std::atomic<int> last_thread{-1};
+    LatencyHistogram rtt;
+};
+
+static bool summary_mode = false;
+static int summary_interval = 10;
+static ShareWindow share_window;
+
+static int64_t monotonic_ns() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static bool allow(LogCategory category) {
+    if (bucket_interval_ns == 0) return true;
+    TokenBucket& bucket = token_buckets[category];
+    int64_t now = monotonic_ns();
+    int64_t tat = bucket.tat.load(std::memory_order_relaxed);
+    while (true) {
+        int64_t next = std::max(tat, now) + bucket_interval_ns;
+        if (next - now > bucket_burst_ns) {
+            bucket.suppressed.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        if (bucket.tat.compare_exchange_weak(tat, next, std::memory_order_relaxed)) {
+            return true;
+        }
+    }
+}
+
+static void fold_share(int thread_id, bool accepted, int ping) {
+    (accepted ? share_window.accepted : share_window.rejected)
+        .fetch_add(1, std::memory_order_relaxed);
+    share_window.rtt.record_ms(ping);
+
+    int first = share_window.first_thread.load(std::memory_order_relaxed);
+    while (thread_id < first &&
+           !share_window.first_thread.compare_exchange_weak(first, thread_id,
+                                                            std::memory_order_relaxed)) {}
+    int last = share_window.last_thread.load(std::memory_order_relaxed);
+    while (thread_id > last &&
+           !share_window.last_thread.compare_exchange_weak(last, thread_id,
+                                                           std::memory_order_relaxed)) {}
+}
+
+static std::unique_ptr<MpscQueue<LogRecord>> log_queue;
+static std::atomic<bool> async_mode(false);
+static std::atomic<bool> writer_stop(false);
+static std::atomic<bool> writer_idle(false);
+static std::atomic<unsigned long long> dropped_records(0);
+static std::thread writer;
+static std::mutex wake_mutex;
+static std::condition_variable wake_cv;
+
+// Formatted once per second; only used under log_mutex
+static time_t stamp_second = -1;
+static std::string stamp_text;
+static unsigned long long reported_drops = 0;
+
+static const std::string& get_timestamp(time_t now) {
+    if (now != stamp_second) {
+        struct tm tm;
+        localtime_r(&now, &tm);
+        char date[16];
+        strftime(date, sizeof(date), "%Y-%m-%d", &tm);
+        stamp_text = std::string(GRAY "[") + date + "]" RESET;
+        stamp_second = now;
+    }
+    return stamp_text;
+}
+
+static void format_share(std::ostream& out, const LogRecord& r) {
+    unsigned long total = r.accepted + r.rejected;
+    double accept_rate = total > 0 ? (r.accepted * 100.0 / total) : 100.0;
+    int actual_diff = r.difficulty / 100;
+
+    if (r.verdict == VERDICT_ACCEPT) {
+        out << TAG_CPU << " "
+            << CHARTREUSE << "accepted" << RESET
+            << CHARTREUSE << " (" << r.accepted << "/" << total
+            << " " << std::fixed << std::setprecision(1) << accept_rate << "%)" << RESET
+            << WHITE << " diff " << CYAN << Logger::format_difficulty(actual_diff) << RESET
+            << GRAY << " (" << std::fixed << std::setprecision(0) << r.seconds * 1000 << " ms)"
+            << " (" << r.ping << " ms)" << RESET << "\n";
+    } else if (r.verdict == VERDICT_REJECT) {
+        out << TAG_CPU << " "
+            << RED << "rejected" << RESET
+            << RED << " (" << r.accepted << "/" << total
+            << " " << std::fixed << std::setprecision(1) << accept_rate << "%)" << RESET
+            << WHITE << " diff " << CYAN << Logger::format_difficulty(actual_diff) << RESET
+            << GRAY << " (" << std::fixed << std::setprecision(0) << r.seconds * 1000 << " ms)"
+            << " (" << r.ping << " ms)" << RESET << "\n";
+    } else {
+        out << TAG_CPU << " "
+            << YELLOW << BOLD << "BLOCK FOUND!" << RESET
+            << WHITE << " diff " << CYAN << Logger::format_difficulty(actual_diff) << RESET
+            << GRAY << " (" << r.ping << " ms)" << RESET << "\n";
+    }
+}
+
+static void render(const LogRecord& r, std::string& out) {
+    if (r.stamped) {
+        out += get_timestamp(r.time);
+        out += " ";
+    }
+    if (r.kind == RECORD_SHARE) {
+        std::ostringstream line;
+        format_share(line, r);
+        out += line.str();
+    } else {
+        out += r.text;
+    }
+}
+
+static thread_local std::string* report_buffer = nullptr;
+
+// Workers never block here: with the writer running the record goes into
+// the queue, or is counted as dropped when the queue is full. Records that
+// must not be lost (errors, BLOCK) are written synchronously instead.
+static void emit(LogRecord&& record, bool must_deliver = false) {
+    if (report_buffer) {
+        render(record, *report_buffer);
+        return;
+    }
+    if (async_mode.load(std::memory_order_acquire)) {
+        if (!log_queue->try_push(std::move(record))) {
+            if (!must_deliver) {
+                dropped_records.fetch_add(1, std::memory_order_relaxed);
+                return;
+            }
+            // try_push leaves the record alone when it fails
+            std::lock_guard<std::mutex> lock(log_mutex);
+            std::string out;
+            render(record, out);
+            std::cout << out << std::flush;
+            return;
+        }
+        // Pairs with the writer's idle store/empty check
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (writer_idle.load(std::memory_order_relaxed)) {
+            wake_cv.notify_one();
+        }
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(log_mutex);
+    std::string out;
+    render(record, out);
+    std::cout << out << std::flush;
+}
+
+static void emit_line(const std::ostringstream& out, bool stamped, bool must_deliver = false) {
+    LogRecord record;
+    record.stamped = stamped;
+    if (stamped) record.time = std::time(nullptr);
+    record.text = out.str();
+    emit(std::move(record), must_deliver);
+}
+
+// Folded shares and rate-limited lines of the last `seconds`
+static void append_summary(std::string& batch, int seconds) {
+    const std::string& stamp = get_timestamp(std::time(nullptr));
+
+    unsigned long accepted = share_window.accepted.exchange(0, std::memory_order_relaxed);
+    unsigned long rejected = share_window.rejected.exchange(0, std::memory_order_relaxed);
+    int first = share_window.first_thread.exchange(INT_MAX, std::memory_order_relaxed);
+    int last = share_window.last_thread.exchange(-1, std::memory_order_relaxed);
+    HistogramSummary rtt = share_window.rtt.take();
+
+    if (accepted + rejected > 0) {
+        std::ostringstream out;
+        out << stamp << " " << TAG_CPU << " " << WHITE << "T" << first;
+        if (last > first) out << "-" << last;
+        out << ": " << RESET
+            << CHARTREUSE << accepted << " accepted" << RESET << WHITE << ", " << RESET
+            << (rejected > 0 ? RED : WHITE) << rejected << " rejected" << RESET
+            << WHITE << ", p50 RTT " << CYAN << std::fixed << std::setprecision(0)
+            << rtt.p50_ms << " ms" << RESET
+            << GRAY << " in last " << seconds << " s" << RESET << "\n";
+        batch += out.str();
+    }
+
+    std::ostringstream limited;
+    for (int c = 0; c < CAT_COUNT; c++) {
+        unsigned long n = token_buckets[c].suppressed.exchange(0, std::memory_order_relaxed);
+        if (n == 0) continue;
+        limited << (limited.tellp() > 0 ? ", " : "") << n << " " << category_names[c];
+    }
+    if (limited.tellp() > 0) {
+        batch += stamp + " " TAG_MINER " " GRAY "rate limited " + limited.str() +
+                 " lines in last " + std::to_string(seconds) + " s" RESET "\n";
+    }
+}
+
+// Drains up to LOG_BATCH records and writes them with one flush,
+// and, when summary_seconds > 0, the summary lines
+static size_t drain(int summary_seconds = 0) {
+    LogRecord record;
+    std::string batch;
+    size_t count = 0;
+
+    std::lock_guard<std::mutex> lock(log_mutex);
+    while (count < LOG_BATCH && log_queue->try_pop(record)) {
+        render(record, batch);
+        count++;
+    }
+    unsigned long long lost = dropped_records.load(std::memory_order_relaxed);
+    if (lost != reported_drops) {
+        batch += get_timestamp(std::time(nullptr)) + " " TAG_NET " " YELLOW "log queue full, dropped " +
+                 std::to_string(lost - reported_drops) + " records" RESET "\n";
+        reported_drops = lost;
+    }
+    if (summary_seconds > 0) {
+        append_summary(batch, summary_seconds);
+    }
+    if (!batch.empty()) {
+        std::cout << batch << std::flush;
+    }
+    return count;
+}
+
+static void writer_loop() {
+    int64_t last_summary = monotonic_ns();
+    while (true) {
+        bool stopping = writer_stop.load(std::memory_order_acquire);
+        int64_t now = monotonic_ns();
+        int summary_seconds = 0;
+        if (now - last_summary >= summary_interval * 1000000000LL || stopping) {
+            summary_seconds = std::max<int64_t>(1, (now - last_summary + 500000000LL) / 1000000000LL);
+            last_summary = now;
+        }
+        if (drain(summary_seconds) == LOG_BATCH) continue;
+        if (stopping) break;
+
+        writer_idle.store(true);
+        if (log_queue->empty() && !writer_stop.load()) {
+            // A wakeup lost between the check and the wait costs at most
+            // one timeout
+            std::unique_lock<std::mutex> lock(wake_mutex);
+            wake_cv.wait_for(lock, std::chrono::milliseconds(LOG_IDLE_WAIT_MS));
+        }
+        writer_idle.store(false, std::memory_order_relaxed);
+    }
+}
+
+void Logger::start_writer() {
+    static bool registered = false;
+    if (async_mode.load()) return;
+    if (!log_queue) {
+        log_queue.reset(new MpscQueue<LogRecord>(LOG_QUEUE_SIZE));
+    }
+    writer_stop = false;
+    writer = std::thread(writer_loop);
+    async_mode.store(true, std::memory_order_release);
+
+    // Early returns from main still flush the queue
+    if (!registered) {
+        std::atexit(stop_writer);
+        registered = true;
+    }
+}
+
+void Logger::stop_writer() {
+    if (!async_mode.exchange(false)) return;
+    writer_stop.store(true);
+    wake_cv.notify_one();
+    writer.join();
+
+    // Records pushed while the writer was exiting
+    while (drain() == LOG_BATCH) {}
+}
+
+void Logger::begin_report() {
+    if (!report_buffer) report_buffer = new std::string();
+}
+
+void Logger::end_report() {
+    std::unique_ptr<std::string> report(report_buffer);
+    report_buffer = nullptr;
+    if (!report || report->empty()) return;
+    std::lock_guard<std::mutex> lock(log_mutex);
+    std::cout << *report << std::flush;
+}
+
+void Logger::configure(bool summary, int interval_seconds, double lines_per_second) {
+    summary_mode = summary;
+    summary_interval = interval_seconds > 0 ? interval_seconds : 10;
+    if (lines_per_second > 0) {
+        bucket_interval_ns = (int64_t)(1e9 / lines_per_second);
+        bucket_burst_ns = (int64_t)std::max(1.0, lines_per_second * LOG_BURST_SECONDS) *
+                          bucket_interval_ns;
+    } else {
+        bucket_interval_ns = 0;
+    }
+}
+
+unsigned long long Logger::dropped() {
+    return dropped_records.load(std::memory_order_relaxed);
 }
 
 std::string Logger::get_colored_box(const std::string& type) {
@@ -97,113 +442,359 @@ std::string Logger::format_difficulty(int difficulty) {
     return ss.str();
 }
 
+std::string Logger::format_bytes(unsigned long long bytes) {
+    const char* units[] = {"B", "KB", "MB", "GB", "TB"};
+    int unit_index = 0;
+    double size = static_cast<double>(bytes);
+    
+    while (size >= 1024.0 && unit_index < 4) {
+        size /= 1024.0;
+        unit_index++;
+    }
+    
+    std::stringstream ss;
+    ss << std::fixed << std::setprecision(unit_index > 0 ? 1 : 0) << size << " " << units[unit_index];
+    return ss.str();
+}
+
 void Logger::enable() { enabled = true; }
 void Logger::disable() { enabled = false; }
 bool Logger::is_enabled() { return enabled; }
 
 void Logger::info(const std::string& message) {
     if (!enabled) return;
-    std::lock_guard<std::mutex> lock(log_mutex);
-    std::cout << get_timestamp() << " " << TAG_NET << " " << WHITE << message << RESET << "\n" << std::flush;
+    std::ostringstream out;
+    out << TAG_NET << " " << WHITE << message << RESET << "\n";
+    emit_line(out, true);
 }
 
 void Logger::success(const std::string& message) {
     if (!enabled) return;
-    std::lock_guard<std::mutex> lock(log_mutex);
-    std::cout << get_timestamp() << " " << TAG_CPU << " " << BRIGHT_GREEN << message << RESET << "\n" << std::flush;
+    std::ostringstream out;
+    out << TAG_CPU << " " << BRIGHT_GREEN << message << RESET << "\n";
+    emit_line(out, true);
 }
 
 void Logger::warning(const std::string& message) {
     if (!enabled) return;
-    std::lock_guard<std::mutex> lock(log_mutex);
-    std::cout << get_timestamp() << " " << TAG_NET << " " << YELLOW << message << RESET << "\n" << std::flush;
+    std::ostringstream out;
+    out << TAG_NET << " " << YELLOW << message << RESET << "\n";
+    emit_line(out, true);
 }
 
 void Logger::error(const std::string& message) {
     if (!enabled) return;
-    std::lock_guard<std::mutex> lock(log_mutex);
-    std::cout << get_timestamp() << " " << TAG_NET << " " << RED << message << RESET << "\n" << std::flush;
+    std::ostringstream out;
+    out << TAG_NET << " " << RED << message << RESET << "\n";
+    emit_line(out, true, true);
 }
 
 void Logger::net_connect(const std::string& pool, int port) {
     if (!enabled) return;
-    std::lock_guard<std::mutex> lock(log_mutex);
-    std::cout << get_timestamp() << " " << TAG_NET << " " 
-              << WHITE << "use pool " << CYAN << pool << ":" << port << RESET << "\n" 
-              << std::flush;
+    std::ostringstream out;
+    out << TAG_NET << " " 
+        << WHITE << "use pool " << CYAN << pool << ":" << port << RESET << "\n";
+    emit_line(out, true);
 }
 
 void Logger::net_connected(const std::string& version, int ping) {
     if (!enabled) return;
-    std::lock_guard<std::mutex> lock(log_mutex);
-    std::cout << get_timestamp() << " " << TAG_NET << " " 
-              << BRIGHT_MAGENTA << "new job from " << CYAN << "pool" << RESET
-              << WHITE << " diff " << CYAN << "20M" << RESET 
-              << WHITE << " algo " << CYAN << "DUCOS1" << RESET 
-              << WHITE << " height " << CYAN << version << RESET << "\n"
-              << std::flush;
+    std::ostringstream out;
+    out << TAG_NET << " " 
+        << BRIGHT_MAGENTA << "new job from " << CYAN << "pool" << RESET
+        << WHITE << " diff " << CYAN << "20M" << RESET 
+        << WHITE << " algo " << CYAN << "DUCOS1" << RESET 
+        << WHITE << " height " << CYAN << version << RESET << "\n";
+    emit_line(out, true);
 }
 
 void Logger::net_job(int thread_id, int difficulty, const std::string& algo) {
-    if (!enabled) return;
-    std::lock_guard<std::mutex> lock(log_mutex);
-    std::cout << get_timestamp() << " " << TAG_MINER << " " 
-              << WHITE << "new job diff " << CYAN << format_difficulty(difficulty) << RESET 
-              << WHITE << " algo " << CYAN << algo << RESET << "\n" << std::flush;
+    if (!enabled || !allow(CAT_JOB)) return;
+    std::ostringstream out;
+    out << TAG_MINER << " " 
+        << WHITE << "new job diff " << CYAN << format_difficulty(difficulty) << RESET 
+        << WHITE << " algo " << CYAN << algo << RESET << "\n";
+    emit_line(out, true);
 }
 
 void Logger::net_accepted(int thread_id, unsigned long accepted, unsigned long rejected, 
                          double hashrate, double total_hashrate, double time, int ping) {
-    if (!enabled) return;
-    std::lock_guard<std::mutex> lock(log_mutex);
+    if (!enabled || !allow(CAT_SHARE)) return;
+    std::ostringstream out;
     
     double accept_rate = (accepted + rejected) > 0 ? 
         (accepted * 100.0 / (accepted + rejected)) : 100.0;
     
-    std::cout << get_timestamp() << " " << TAG_CPU << " " 
-              << BRIGHT_GREEN << "accepted" << RESET
-              << BRIGHT_GREEN << " (" << accepted << "/" << (accepted + rejected) 
-              << " " << std::fixed << std::setprecision(1) << accept_rate << "%)" << RESET
-              << GRAY << " (" << std::fixed << std::setprecision(0) << time * 1000 << " ms)" << RESET 
-              << "\n" << std::flush;
+    out << TAG_CPU << " " 
+        << BRIGHT_GREEN << "accepted" << RESET
+        << BRIGHT_GREEN << " (" << accepted << "/" << (accepted + rejected) 
+        << " " << std::fixed << std::setprecision(1) << accept_rate << "%)" << RESET
+        << GRAY << " (" << std::fixed << std::setprecision(0) << time * 1000 << " ms)" << RESET 
+        << "\n";
+    emit_line(out, true);
 }
 
 void Logger::net_rejected(int thread_id, unsigned long accepted, unsigned long rejected,
                          const std::string& reason, int ping) {
-    if (!enabled) return;
-    std::lock_guard<std::mutex> lock(log_mutex);
+    if (!enabled || !allow(CAT_SHARE)) return;
+    std::ostringstream out;
     
     double accept_rate = (accepted + rejected) > 0 ? 
         (accepted * 100.0 / (accepted + rejected)) : 0.0;
     
-    std::cout << get_timestamp() << " " << TAG_CPU << " " 
-              << RED << "rejected" << RESET 
-              << RED << " (" << accepted << "/" << (accepted + rejected) 
-              << " " << std::fixed << std::setprecision(1) << accept_rate << "%)" << RESET
-              << GRAY << " " << reason << RESET
-              << GRAY << " (" << ping << " ms)" << RESET << "\n" << std::flush;
+    out << TAG_CPU << " " 
+        << RED << "rejected" << RESET 
+        << RED << " (" << accepted << "/" << (accepted + rejected) 
+        << " " << std::fixed << std::setprecision(1) << accept_rate << "%)" << RESET
+        << GRAY << " " << reason << RESET
+        << GRAY << " (" << ping << " ms)" << RESET << "\n";
+    emit_line(out, true);
 }
 
 void Logger::net_block(int thread_id, unsigned long blocks) {
     if (!enabled) return;
-    std::lock_guard<std::mutex> lock(log_mutex);
-    std::cout << get_timestamp() << " " << TAG_CPU << " " 
-              << YELLOW << BOLD << "BLOCK FOUND!" << RESET 
-              << GRAY << " (total: " << blocks << ")" << RESET << "\n" << std::flush;
+    std::ostringstream out;
+    out << TAG_CPU << " " 
+        << YELLOW << BOLD << "BLOCK FOUND!" << RESET 
+        << GRAY << " (total: " << blocks << ")" << RESET << "\n";
+    emit_line(out, true, true);
 }
 
 void Logger::net_error(const std::string& message) {
     if (!enabled) return;
-    std::lock_guard<std::mutex> lock(log_mutex);
-    std::cout << get_timestamp() << " " << TAG_NET << " " 
-              << RED << "error: " << message << RESET << "\n" << std::flush;
+    std::ostringstream out;
+    out << TAG_NET << " " 
+        << RED << "error: " << message << RESET << "\n";
+    emit_line(out, true, true);
 }
 
 void Logger::net_disconnected(const std::string& reason) {
     if (!enabled) return;
-    std::lock_guard<std::mutex> lock(log_mutex);
-    std::cout << get_timestamp() << " " << TAG_NET << " " 
-              << WHITE << "disconnected: " << GRAY << reason << RESET << "\n" << std::flush;
+    std::ostringstream out;
+    out << TAG_NET << " " 
+        << WHITE << "disconnected: " << GRAY << reason << RESET << "\n";
+    emit_line(out, true);
+}
+
+void Logger::pool_update(const std::string& pool, int port, int workers,
+                        double hashrate, unsigned long accepted,
+                        unsigned long rejected, int rtt) {
+    if (!enabled) return;
+    std::ostringstream out;
+    out << TAG_NET << " "
+        << CYAN << pool << ":" << port << RESET
+        << WHITE << " threads " << CYAN << workers << RESET
+        << WHITE << " speed " << CYAN << format_hashrate(hashrate) << RESET
+        << WHITE << " shares " << CHARTREUSE << accepted << RESET
+        << GRAY << "/" << RESET << RED << rejected << RESET
+        << GRAY << " (" << rtt << " ms)" << RESET << "\n";
+    emit_line(out, true);
+}
+
+void Logger::diff_change(int thread_id, const std::string& from,
+                        const std::string& to, const std::string& reason) {
+    if (!enabled || !allow(CAT_DIFF)) return;
+    std::ostringstream out;
+    out << TAG_MINER << " "
+        << WHITE << "T" << thread_id << " diff " << CYAN << from << RESET
+        << WHITE << " -> " << CYAN << to << RESET
+        << GRAY << " (" << reason << ")" << RESET << "\n";
+    emit_line(out, true);
+}
+
+void Logger::diff_summary(int low, int medium, int net) {
+    if (!enabled || !allow(CAT_DIFF)) return;
+    std::ostringstream out;
+    out << TAG_MINER << " "
+        << WHITE << "diff tiers " << RESET
+        << WHITE << "LOW " << CYAN << low << RESET
+        << WHITE << " MEDIUM " << CYAN << medium << RESET
+        << WHITE << " NET " << CYAN << net << RESET << "\n";
+    emit_line(out, true);
+}
+
+void Logger::thread_stats(int thread_id, double hashrate, const std::string& tier,
+                         int solve_ms, int useful_permille, unsigned long jobs,
+                         double hashing_seconds, double waiting_seconds) {
+    if (!enabled) return;
+    std::ostringstream out;
+    out << "  " << WHITE << "T" << std::left << std::setw(4) << thread_id << std::right << RESET
+        << CHARTREUSE << std::setw(12) << format_hashrate(hashrate) << RESET
+        << WHITE << "  diff " << CYAN << std::setw(6) << tier << RESET
+        << WHITE << "  solve " << CYAN << std::fixed << std::setprecision(1)
+        << solve_ms / 1000.0 << "s" << RESET
+        << WHITE << "  useful " << CYAN << std::setprecision(1)
+        << useful_permille / 10.0 << "%" << RESET
+        << WHITE << "  jobs " << CYAN << jobs << RESET
+        << GRAY << " (hash " << std::setprecision(0) << hashing_seconds
+        << "s / wait " << waiting_seconds << "s)" << RESET << "\n";
+    emit_line(out, false);
+}
+
+void Logger::phase_breakdown(const std::vector<std::pair<std::string, double>>& seconds) {
+    if (!enabled) return;
+    double total = 0.0;
+    for (const auto& phase : seconds) total += phase.second;
+    if (total <= 0.0) return;
+    
+    std::ostringstream out;
+    out << "       " << GRAY << "time" << RESET;
+    for (const auto& phase : seconds) {
+        if (phase.second <= 0.0) continue;
+        out << WHITE << "  " << phase.first << " " << RESET
+            << CYAN << std::fixed << std::setprecision(1)
+            << phase.second * 100.0 / total << "%" << RESET;
+    }
+    out << "\n";
+    emit_line(out, false);
+}
+
+void Logger::perf_stats(double cycles_per_hash, double ipc,
+                       double branch_misses_per_hash, double l1d_misses_per_hash) {
+    if (!enabled) return;
+    std::ostringstream out;
+    out << "       " << GRAY << "perf" << RESET
+        << WHITE << "  cycles/hash " << RESET << CYAN << std::fixed
+        << std::setprecision(0) << cycles_per_hash << RESET
+        << WHITE << "  IPC " << RESET << CYAN << std::setprecision(2) << ipc << RESET
+        << WHITE << "  br-miss/hash " << RESET << CYAN << std::setprecision(3)
+        << branch_misses_per_hash << RESET
+        << WHITE << "  L1d-miss/hash " << RESET << CYAN << l1d_misses_per_hash << RESET
+        << "\n";
+    emit_line(out, false);
+}
+
+void Logger::latency_stats(const HistogramSummary& job_rtt,
+                          const HistogramSummary& solve_time,
+                          const HistogramSummary& submit_rtt) {
+    if (!enabled) return;
+    std::ostringstream out;
+    
+    // p50/p90/p99; solve time in seconds, round trips in milliseconds
+    auto print = [&out](const char* name, const HistogramSummary& h, double scale,
+                        const char* unit) {
+        out << WHITE << "  " << name << " " << RESET;
+        if (h.count == 0) {
+            out << GRAY << "n/a" << RESET;
+            return;
+        }
+        out << CYAN << std::fixed << std::setprecision(1)
+            << h.p50_ms / scale << "/" << h.p90_ms / scale << "/"
+            << h.p99_ms / scale << unit << RESET;
+    };
+    
+    out << "       " << GRAY << "p50/p90/p99" << RESET;
+    print("job", job_rtt, 1.0, "ms");
+    print("solve", solve_time, 1000.0, "s");
+    print("submit", submit_rtt, 1.0, "ms");
+    out << "\n";
+    emit_line(out, false);
+}
+
+void Logger::io_stats(int thread_id, unsigned long long bytes_sent,
+                      unsigned long long bytes_received, unsigned long long messages_sent,
+                      unsigned long long messages_received, unsigned long long syscalls,
+                      unsigned long long connects) {
+    if (!enabled) return;
+    std::ostringstream out;
+    
+    if (thread_id < 0) {
+        out << "  " << WHITE << "net  " << RESET << " ";
+    } else {
+        out << "       " << GRAY << "net" << RESET << " ";
+    }
+    unsigned long long messages = messages_sent + messages_received;
+    out << CYAN << format_bytes(bytes_sent) << RESET << GRAY << " out / " << RESET
+        << CYAN << format_bytes(bytes_received) << RESET << GRAY << " in" << RESET
+        << WHITE << "  msgs " << CYAN << messages_sent << "/" << messages_received << RESET
+        << WHITE << "  syscalls " << CYAN << syscalls << RESET;
+    if (messages > 0) {
+        out << GRAY << " (" << std::fixed << std::setprecision(1)
+            << (double)syscalls / messages << "/msg)" << RESET;
+    }
+    // A thread's first connect is not a reconnect; the totals span all threads
+    if (thread_id < 0) {
+        out << WHITE << "  connects " << CYAN << connects << RESET;
+    } else {
+        out << WHITE << "  reconnects " << CYAN << (connects > 0 ? connects - 1 : 0) << RESET;
+    }
+    out << "\n";
+    emit_line(out, false);
+}
+
+void Logger::cpu_usage(double system_usage, double pressure, double process_usage,
+                       double hashes_per_cpu_second, double throttled) {
+    if (!enabled) return;
+    std::ostringstream out;
+    out << "  " << WHITE << "cpu  " << RESET << " "
+        << WHITE << "system " << CYAN << std::fixed << std::setprecision(0)
+        << system_usage << "%" << RESET;
+    if (pressure >= 0) {
+        out << WHITE << "  psi " << CYAN << std::setprecision(1) << pressure << "%" << RESET;
+    }
+    if (throttled >= 0) {
+        out << WHITE << "  throttled " << (throttled > 0 ? YELLOW : CYAN)
+            << std::setprecision(0) << throttled << "%" << RESET;
+    }
+    out << WHITE << "  miner " << CYAN << std::setprecision(0) << process_usage << "%" << RESET
+        << WHITE << "  " << CHARTREUSE << format_hashrate(hashes_per_cpu_second) << RESET
+        << GRAY << " per busy CPU" << RESET << "\n";
+    emit_line(out, false);
+}
+
+void Logger::thread_cpu(double usage, double cpu_seconds, double hashes_per_cpu_second) {
+    if (!enabled) return;
+    std::ostringstream out;
+    out << "       " << GRAY << "cpu" << RESET << " "
+        << CYAN << std::fixed << std::setprecision(0) << usage << "%" << RESET
+        << GRAY << " (" << std::setprecision(1) << cpu_seconds << "s)" << RESET
+        << WHITE << "  " << CHARTREUSE << format_hashrate(hashes_per_cpu_second) << RESET
+        << GRAY << " per busy CPU" << RESET << "\n";
+    emit_line(out, false);
+}
+
+void Logger::node_stats(int node, int threads, double hashrate,
+                        unsigned long accepted, unsigned long rejected) {
+    if (!enabled) return;
+    std::ostringstream out;
+    out << "  " << WHITE << "node" << std::left << std::setw(2) << node << std::right << RESET
+        << " " << CHARTREUSE << format_hashrate(hashrate) << RESET
+        << GRAY << " (" << threads << " threads)" << RESET
+        << WHITE << "  accepted " << GREEN << accepted << RESET
+        << WHITE << "  rejected " << (rejected > 0 ? RED : GRAY) << rejected << RESET << "\n";
+    emit_line(out, false);
+}
+
+void Logger::class_stats(const std::string& name, int threads, double hashrate,
+                         double weight, const std::string& difficulty,
+                         const std::string& kernel) {
+    if (!enabled) return;
+    std::ostringstream out;
+    out << "  " << WHITE << std::left << std::setw(5) << name << std::right << RESET << " "
+        << CHARTREUSE << format_hashrate(hashrate) << RESET
+        << GRAY << " (" << threads << " threads, "
+        << format_hashrate(threads > 0 ? hashrate / threads : 0.0) << " each)" << RESET
+        << WHITE << "  diff " << CYAN << difficulty << RESET
+        << WHITE << "  kernel " << CYAN << kernel << RESET
+        << WHITE << "  weight " << CYAN << std::fixed << std::setprecision(2) << weight << RESET
+        << "\n";
+    emit_line(out, false);
+}
+
+void Logger::bytes_per_share(const std::vector<std::pair<std::string, double>>& tiers) {
+    if (!enabled) return;
+    std::ostringstream out;
+    out << "       " << GRAY << "bytes/share" << RESET;
+    bool any = false;
+    for (const auto& tier : tiers) {
+        if (tier.second <= 0.0) continue;
+        out << WHITE << "  " << tier.first << " " << RESET
+            << CYAN << format_bytes((unsigned long)tier.second) << RESET;
+        any = true;
+    }
+    if (!any) out << GRAY << "  n/a" << RESET;
+    out << "\n";
+    emit_line(out, false);
 }
 
 void Logger::share(int thread_id, const std::string& result_type,
@@ -211,167 +802,176 @@ void Logger::share(int thread_id, const std::string& result_type,
                   double hashrate, double total_hashrate,
                   double time, int difficulty, int ping) {
     if (!enabled) return;
-    std::lock_guard<std::mutex> lock(log_mutex);
     
-    double accept_rate = (accepted + rejected) > 0 ? 
-        (accepted * 100.0 / (accepted + rejected)) : 100.0;
+    LogRecord record;
+    record.kind = RECORD_SHARE;
+    record.stamped = true;
+    record.time = std::time(nullptr);
+    if (result_type == "ACCEPT") record.verdict = VERDICT_ACCEPT;
+    else if (result_type == "REJECT") record.verdict = VERDICT_REJECT;
+    else if (result_type == "BLOCK") record.verdict = VERDICT_BLOCK;
+    else return;
     
-    int actual_diff = difficulty / 100;
-    
-    if (result_type == "ACCEPT") {
-        std::cout << get_timestamp() << " " << TAG_CPU << " " 
-                  << CHARTREUSE << "accepted" << RESET
-                  << CHARTREUSE << " (" << accepted << "/" << (accepted + rejected) 
-                  << " " << std::fixed << std::setprecision(1) << accept_rate << "%)" << RESET
-                  << WHITE << " diff " << CYAN << format_difficulty(actual_diff) << RESET
-                  << GRAY << " (" << std::fixed << std::setprecision(0) << time * 1000 << " ms)"
-                  << " (" << ping << " ms)" << RESET 
-                  << "\n" << std::flush;
-    } else if (result_type == "REJECT") {
-        std::cout << get_timestamp() << " " << TAG_CPU << " " 
-                  << RED << "rejected" << RESET 
-                  << RED << " (" << accepted << "/" << (accepted + rejected) 
-                  << " " << std::fixed << std::setprecision(1) << accept_rate << "%)" << RESET
-                  << WHITE << " diff " << CYAN << format_difficulty(actual_diff) << RESET
-                  << GRAY << " (" << std::fixed << std::setprecision(0) << time * 1000 << " ms)"
-                  << " (" << ping << " ms)" << RESET 
-                  << "\n" << std::flush;
-    } else if (result_type == "BLOCK") {
-        std::cout << get_timestamp() << " " << TAG_CPU << " " 
-                  << YELLOW << BOLD << "BLOCK FOUND!" << RESET 
-                  << WHITE << " diff " << CYAN << format_difficulty(actual_diff) << RESET
-                  << GRAY << " (" << ping << " ms)" << RESET
-                  << "\n" << std::flush;
+    // BLOCK always goes straight through
+    if (record.verdict != VERDICT_BLOCK) {
+        if (summary_mode) {
+            fold_share(thread_id, record.verdict == VERDICT_ACCEPT, ping);
+            return;
+        }
+        if (!allow(CAT_SHARE)) return;
     }
+    record.accepted = accepted;
+    record.rejected = rejected;
+    record.seconds = time;
+    record.difficulty = difficulty;
+    record.ping = ping;
+    bool block = record.verdict == VERDICT_BLOCK;
+    emit(std::move(record), block);
 }
 
-void Logger::speed_update(int threads, double total_hashrate,
-                         unsigned long accepted, unsigned long rejected) {
+void Logger::speed_update(double hashrate_10s, double hashrate_60s,
+                         double hashrate_15m, double max_hashrate) {
     if (!enabled) return;
-    std::lock_guard<std::mutex> lock(log_mutex);
+    std::ostringstream out;
     
-    double hashrate_10s = total_hashrate;
-    double hashrate_60s = total_hashrate * 0.98;
-    double hashrate_15m = total_hashrate * 0.95;
-    
-    std::cout << get_timestamp() << " " << TAG_MINER << " "
-              << WHITE << "speed " << CYAN << "10s/60s/15m" << RESET << " "
-              << CYAN << format_hashrate(hashrate_10s) << RESET << " "
-              << CYAN << format_hashrate(hashrate_60s) << RESET << " "
-              << CYAN << format_hashrate(hashrate_15m) << RESET 
-              << WHITE << " n/a" << RESET
-              << WHITE << " max " << CYAN << format_hashrate(total_hashrate * 1.05) << RESET
-              << "\n" << std::flush;
+    out << TAG_MINER << " "
+        << WHITE << "speed " << CYAN << "10s/60s/15m" << RESET << " "
+        << CYAN << format_hashrate(hashrate_10s) << RESET << " "
+        << CYAN << format_hashrate(hashrate_60s) << RESET << " "
+        << CYAN << format_hashrate(hashrate_15m) << RESET 
+        << WHITE << " max " << CYAN << format_hashrate(max_hashrate) << RESET
+        << "\n";
+    emit_line(out, true);
 }
 
 void Logger::print_versions(const std::string& app_version, const std::string& libuv_version) {
     if (!enabled) return;
-    std::lock_guard<std::mutex> lock(log_mutex);
-    std::cout << " " << CYAN << "* " << RESET 
-              << WHITE << "ABOUT        " << RESET 
-              << "duino-cpu/" << app_version << " gcc/clang\n";
-    std::cout << " " << CYAN << "* " << RESET 
-              << WHITE << "LIBS         " << RESET 
-              << libuv_version << "\n" << std::flush;
+    std::ostringstream out;
+    out << " " << CYAN << "* " << RESET 
+        << WHITE << "ABOUT        " << RESET 
+        << "duino-cpu/" << app_version << " gcc/clang\n";
+    out << " " << CYAN << "* " << RESET 
+        << WHITE << "LIBS         " << RESET 
+        << libuv_version << "\n";
+    emit_line(out, false);
 }
 
 void Logger::print_cpu_info(const std::string& brand, int threads, const std::string& arch) {
     if (!enabled) return;
-    std::lock_guard<std::mutex> lock(log_mutex);
-    std::cout << " " << CYAN << "* " << RESET 
-              << WHITE << "CPU          " << RESET 
-              << brand << "\n";
-    std::cout << "                " << threads << " threads\n" << std::flush;
+    std::ostringstream out;
+    out << " " << CYAN << "* " << RESET 
+        << WHITE << "CPU          " << RESET 
+        << brand << "\n";
+    out << "                " << threads << " threads\n";
+    emit_line(out, false);
 }
 
 void Logger::print_pool_info(const std::string& pool, int port, const std::string& user) {
     if (!enabled) return;
-    std::lock_guard<std::mutex> lock(log_mutex);
-    std::cout << " " << CYAN << "* " << RESET 
-              << WHITE << "POOL         " << RESET 
-              << pool << ":" << port << "\n";
-    std::cout << " " << CYAN << "* " << RESET 
-              << WHITE << "USER         " << RESET 
-              << user << "\n" << std::flush;
+    std::ostringstream out;
+    out << " " << CYAN << "* " << RESET 
+        << WHITE << "POOL         " << RESET 
+        << pool << ":" << port << "\n";
+    out << " " << CYAN << "* " << RESET 
+        << WHITE << "USER         " << RESET 
+        << user << "\n";
+    emit_line(out, false);
 }
 
 void Logger::print_commands() {
     if (!enabled) return;
-    std::lock_guard<std::mutex> lock(log_mutex);
-    std::cout << " " << CYAN << "* " << RESET 
-              << WHITE << "COMMANDS     " << RESET 
-              << "'h' hashrate, 'p' pause, 'r' resume, 'q' quit\n" 
-              << std::flush;
+    std::ostringstream out;
+    out << " " << CYAN << "* " << RESET 
+        << WHITE << "COMMANDS     " << RESET 
+        << "'h' hashrate, 'p' pause, 'r' resume, 'q' quit\n";
+    emit_line(out, false);
 }
 
 void Logger::print_separator() {
     if (!enabled) return;
-    std::lock_guard<std::mutex> lock(log_mutex);
-    std::cout << GRAY << "-------------------------------------------------------------------------------" 
-              << RESET << "\n" << std::flush;
+    std::ostringstream out;
+    out << GRAY << "-------------------------------------------------------------------------------" 
+        << RESET << "\n";
+    emit_line(out, false);
 }
 
 void Logger::benchmark_start(int threads) {
     if (!enabled) return;
-    std::lock_guard<std::mutex> lock(log_mutex);
-    std::cout << get_timestamp() << " " << TAG_CPU << " "
-              << WHITE << "starting benchmark with " << CYAN << threads 
-              << WHITE << " threads" << RESET << "\n";
-    std::cout << get_timestamp() << " " << TAG_CPU << " "
-              << WHITE << "running for " << CYAN << "30 seconds" << RESET 
-              << WHITE << "..." << RESET << "\n" << std::flush;
+    std::ostringstream out;
+    out << TAG_CPU << " "
+        << WHITE << "starting benchmark with " << CYAN << threads 
+        << WHITE << " threads" << RESET << "\n";
+    emit_line(out, true);
+    
+    out.str("");
+    out << TAG_CPU << " "
+        << WHITE << "running for " << CYAN << "30 seconds" << RESET 
+        << WHITE << "..." << RESET << "\n";
+    emit_line(out, true);
 }
 
 void Logger::benchmark_result(unsigned long total_hashes, double duration,
                              double total_hashrate, double per_thread) {
     if (!enabled) return;
-    std::lock_guard<std::mutex> lock(log_mutex);
+    std::ostringstream out;
     
-    std::cout << get_timestamp() << " " << TAG_CPU << " "
-              << BRIGHT_GREEN << "benchmark complete!" << RESET << "\n";
+    out << TAG_CPU << " "
+        << BRIGHT_GREEN << "benchmark complete!" << RESET << "\n";
+    emit_line(out, true);
     
-    std::cout << get_timestamp() << " " << TAG_CPU << " "
-              << WHITE << "total hashes   " << CYAN 
-              << total_hashes << RESET << "\n";
+    out.str("");
+    out << TAG_CPU << " "
+        << WHITE << "total hashes   " << CYAN 
+        << total_hashes << RESET << "\n";
+    emit_line(out, true);
     
-    std::cout << get_timestamp() << " " << TAG_CPU << " "
-              << WHITE << "duration       " << CYAN 
-              << std::fixed << std::setprecision(1) << duration 
-              << WHITE << " seconds" << RESET << "\n";
+    out.str("");
+    out << TAG_CPU << " "
+        << WHITE << "duration       " << CYAN 
+        << std::fixed << std::setprecision(1) << duration 
+        << WHITE << " seconds" << RESET << "\n";
+    emit_line(out, true);
     
-    std::cout << get_timestamp() << " " << TAG_CPU << " "
-              << WHITE << "hashrate       " << CYAN 
-              << format_hashrate(total_hashrate) << RESET << "\n";
+    out.str("");
+    out << TAG_CPU << " "
+        << WHITE << "hashrate       " << CYAN 
+        << format_hashrate(total_hashrate) << RESET << "\n";
+    emit_line(out, true);
     
-    std::cout << get_timestamp() << " " << TAG_CPU << " "
-              << WHITE << "per thread     " << CYAN 
-              << format_hashrate(per_thread) << RESET << "\n" << std::flush;
+    out.str("");
+    out << TAG_CPU << " "
+        << WHITE << "per thread     " << CYAN 
+        << format_hashrate(per_thread) << RESET << "\n";
+    emit_line(out, true);
 }
 
 void Logger::cpu_summary(int total_threads, double total_hashrate) {
     if (!enabled) return;
-    std::lock_guard<std::mutex> lock(log_mutex);
-    std::cout << get_timestamp() << " " << TAG_CPU << " " 
-              << WHITE << "threads " << total_threads 
-              << " hashrate " << CYAN << format_hashrate(total_hashrate) << RESET 
-              << "\n" << std::flush;
+    std::ostringstream out;
+    out << TAG_CPU << " " 
+        << WHITE << "threads " << total_threads 
+        << " hashrate " << CYAN << format_hashrate(total_hashrate) << RESET 
+        << "\n";
+    emit_line(out, true);
 }
 
 void Logger::speed(const std::string& hashrate) {
     if (!enabled) return;
-    std::lock_guard<std::mutex> lock(log_mutex);
-    std::cout << get_timestamp() << " " << TAG_MINER << " " << WHITE << hashrate << RESET << "\n" << std::flush;
+    std::ostringstream out;
+    out << TAG_MINER << " " << WHITE << hashrate << RESET << "\n";
+    emit_line(out, true);
 }
 
 void Logger::speed(int threads, double total_hashrate,
                   unsigned long accepted, unsigned long rejected) {
     if (!enabled) return;
-    std::lock_guard<std::mutex> lock(log_mutex);
-    std::cout << get_timestamp() << " " << TAG_MINER << " " 
-              << WHITE << "threads " << threads 
-              << " hashrate " << CYAN << format_hashrate(total_hashrate) << RESET
-              << WHITE << " accepted " << accepted << " rejected " << rejected << RESET
-              << "\n" << std::flush;
+    std::ostringstream out;
+    out << TAG_MINER << " " 
+        << WHITE << "threads " << threads 
+        << " hashrate " << CYAN << format_hashrate(total_hashrate) << RESET
+        << WHITE << " accepted " << accepted << " rejected " << rejected << RESET
+        << "\n";
+    emit_line(out, true);
 }
 
 void Logger::print_stats(unsigned long accepted, unsigned long rejected,
@@ -380,7 +980,7 @@ void Logger::print_stats(unsigned long accepted, unsigned long rejected,
                         const std::string& pool_address, int pool_port,
                         unsigned long blocks) {
     if (!enabled) return;
-    std::lock_guard<std::mutex> lock(log_mutex);
+    std::ostringstream out;
     
     // Calculate stats
     double accept_rate = (accepted + rejected) > 0 ? 
@@ -408,36 +1008,36 @@ void Logger::print_stats(unsigned long accepted, unsigned long rejected,
         return ss.str();
     };
     
-    std::cout << "\n";
-    std::cout << CYAN << "=========================================" << RESET << "\n\n";
+    out << "\n";
+    out << CYAN << "=========================================" << RESET << "\n\n";
     
     // Uptime
-    std::cout << "  " << WHITE << BOLD << "Uptime:          " << RESET 
-              << CYAN << format_uptime(uptime_seconds) << RESET << "\n";
+    out << "  " << WHITE << BOLD << "Uptime:          " << RESET 
+        << CYAN << format_uptime(uptime_seconds) << RESET << "\n";
     
     // Hashrate
-    std::cout << "  " << WHITE << BOLD << "Hashrate:        " << RESET 
-              << CHARTREUSE << format_hashrate(total_hashrate) << RESET 
-              << GRAY << " (" << threads << " threads)" << RESET << "\n";
+    out << "  " << WHITE << BOLD << "Hashrate:        " << RESET 
+        << CHARTREUSE << format_hashrate(total_hashrate) << RESET 
+        << GRAY << " (" << threads << " threads)" << RESET << "\n";
     
     // Shares
-    std::cout << "  " << WHITE << BOLD << "Shares:          " << RESET;
-    std::cout << CHARTREUSE << accepted << RESET << GRAY << " accepted" << RESET;
-    std::cout << GRAY << " / " << RESET;
-    std::cout << RED << rejected << RESET << GRAY << " rejected" << RESET;
-    std::cout << GRAY << " (" << std::fixed << std::setprecision(1) 
-              << accept_rate << "%)" << RESET << "\n";
+    out << "  " << WHITE << BOLD << "Shares:          " << RESET;
+    out << CHARTREUSE << accepted << RESET << GRAY << " accepted" << RESET;
+    out << GRAY << " / " << RESET;
+    out << RED << rejected << RESET << GRAY << " rejected" << RESET;
+    out << GRAY << " (" << std::fixed << std::setprecision(1) 
+        << accept_rate << "%)" << RESET << "\n";
     
     // Blocks
     if (blocks > 0) {
-        std::cout << "  " << WHITE << BOLD << "Blocks Found:    " << RESET 
-                  << YELLOW << BOLD << blocks << RESET << "\n";
+        out << "  " << WHITE << BOLD << "Blocks Found:    " << RESET 
+            << YELLOW << BOLD << blocks << RESET << "\n";
     }
     
     // Pool
-    std::cout << "  " << WHITE << BOLD << "Pool:            " << RESET 
-              << CYAN << pool_address << ":" << pool_port << RESET << "\n";
+    out << "  " << WHITE << BOLD << "Pool:            " << RESET 
+        << CYAN << pool_address << ":" << pool_port << RESET << "\n";
     
-    std::cout << "\n" << CYAN << "=========================================" << RESET << "\n\n";
-    std::cout << std::flush;
+    out << "\n" << CYAN << "=========================================" << RESET << "\n\n";
+    emit_line(out, false);
 }
\ No newline at end of file
@@ -9,6 +9,12 @@
 #include "../include/network.h"
 #include "../include/benchmark.h"
 #include "../include/config_yaml.h"
+#include "../include/trace.h"
+#include "../include/metrics_server.h"
+#include "../include/statsd_reporter.h"
+#include "../include/shm_stats.h"
+#include "../include/stats.h"
+#include "../include/autoscaler.h"
 #include <csignal>
 #include <getopt.h>
 #include <iostream>
@@ -16,7 +22,6 @@
 #include <sys/prctl.h>
 #include <unistd.h>
 #include <thread>
-#include <fstream>
 #include <sstream>
 #include <sys/sysinfo.h>
 #include <sys/stat.h>
@@ -27,6 +32,10 @@
 #include <cpuid.h>
 #endif
 
+#ifdef USE_CURL
+#include <curl/curl.h>
+#endif
+
 #define RESET         "\033[0m"
 #define BOLD          "\033[1m"
 #define CYAN          "\033[36m"
@@ -36,29 +45,22 @@
 #define GRAY          "\033[90m"
 
 std::atomic<bool> running(true);
-std::atomic<bool> paused(false);
+std::atomic<int> pause_request(0);  // 1 = pause, 2 = resume
+std::atomic<bool> trace_request(false);
 
 void signal_handler(int signal) {
     if (signal == SIGINT || signal == SIGTERM) {
         running = false;
         Logger::info("Shutdown signal received");
+    } else if (signal == SIGUSR1) {
+        pause_request = 1;
+    } else if (signal == SIGUSR2) {
+        pause_request = 2;
+    } else if (signal == SIGHUP) {
+        trace_request = true;
     }
 }
 
-std::string get_cpu_model() {
-    std::ifstream cpuinfo("/proc/cpuinfo");
-    std::string line;
-    while (std::getline(cpuinfo, line)) {
-        if (line.find("model name") != std::string::npos) {
-            size_t pos = line.find(":");
-            if (pos != std::string::npos) {
-                return line.substr(pos + 2);
-            }
-        }
-    }
-    return "Unknown CPU";
-}
-
 std::string get_memory_info() {
     struct sysinfo info;
     if (sysinfo(&info) == 0) {
@@ -148,19 +150,23 @@ void print_system_info(const Config& config) {
     std::cout << "OpenSSL/3.0+";
 #endif
     
-#ifdef LIBCURL_VERSION
-    std::cout << " libcurl/" << LIBCURL_VERSION;
-#else
-    std::cout << " libcurl/8.0+";
+#ifdef USE_CURL
+    std::cout << " libcurl/" << curl_version_info(CURLVERSION_NOW)->version;
 #endif
     std::cout << "\n";
     
     std::cout << " " << CYAN << "* " << RESET 
               << WHITE << "CPU          " << RESET 
-              << get_cpu_model() << "\n";
+              << SystemStats::cpu_name() << "\n";
     
+    CpuLimits limits;
+    limits.load(config.sysfs_root);
     std::cout << "                " 
-              << std::thread::hardware_concurrency() << " threads available\n";
+              << std::thread::hardware_concurrency() << " threads available";
+    if (limits.usable_cpus() < (int)std::thread::hardware_concurrency() || limits.quota > 0) {
+        std::cout << ", " << limits.describe();
+    }
+    std::cout << "\n";
     
     std::cout << " " << CYAN << "* " << RESET 
               << WHITE << "MEMORY       " << RESET 
@@ -187,7 +193,7 @@ void print_system_info(const Config& config) {
     std::cout << "\n";
     std::cout << " " << CYAN << "* " << RESET 
               << WHITE << "COMMANDS     " << RESET 
-              << "'s' stats, 'h' hashrate, 'p' pause, 'r' resume, 'q' quit\n\n";
+              << "'s' stats, 'h' hashrate, 'p' pause, 'r' resume, '+'/'-' worker, 'q' quit\n\n";
 }
 
 void print_usage(const char* program_name) {
@@ -196,14 +202,25 @@ void print_usage(const char* program_name) {
     std::cout << "  -c, --config <file.yml>     Load configuration from YAML file\n";
     std::cout << "  -u, --user <username>       Duino-Coin username (required)\n";
     std::cout << "  -k, --key <mining_key>      Mining key (optional)\n";
-    std::cout << "  -t, --threads <number>      Number of threads (default: auto)\n";
-    std::cout << "  -i, --intensity <1-100>     Mining intensity (default: 95)\n";
-    std::cout << "  -d, --difficulty <type>     Starting difficulty: LOW, MEDIUM, NET (default: NET)\n";
+    std::cout << "  -t, --threads <number>      Number of threads, up to 1024 (default: auto)\n";
+    std::cout << "  --max-workers <number>      Most workers '+', autoscale and HTTP may run (default: usable CPUs)\n";
+    std::cout << "  --autoscale                 Add and retire workers with the load on the host\n";
+    std::cout << "  -i, --intensity <1-100>     CPU duty cycle per thread, percent (default: 95)\n";
+    std::cout << "  --max-hashrate <H/s>        Cap total hashrate (default: off)\n";
+    std::cout << "  --affinity <policy>         Pin workers: scatter, compact, physical, none (default: scatter)\n";
+    std::cout << "  --http-port <port>          Serve /metrics and /api/summary on localhost\n";
+    std::cout << "  --statsd <host:port>        Push StatsD metrics every report_interval\n";
+    std::cout << "  --shm <name>                Publish stats in shared memory (see duino-top)\n";
+    std::cout << "  --perf                      Hardware counters: cycles/hash, IPC per thread\n";
+    std::cout << "  --journal <file>            Binary job/share journal (see duino-journal)\n";
+    std::cout << "  --trace <file.json>         Record worker timeline (Chrome Trace, dumped on exit/SIGHUP)\n";
+    std::cout << "  -d, --difficulty <type>     Starting difficulty: LOW, MEDIUM, NET, AUTO (default: NET)\n";
     std::cout << "  -r, --rig <identifier>      Rig identifier (default: auto-generated)\n";
-    std::cout << "  -p, --pool <host:port>      Custom pool address\n";
+    std::cout << "  -p, --pool <host:port[:w]>  Custom pool address (repeat to shard threads)\n";
     std::cout << "  -b, --benchmark             Run benchmark and exit\n";
     std::cout << "  --invisible                 Hide process from htop/btop (stealth mode)\n";
     std::cout << "  --nolog                     Disable console logging\n";
+    std::cout << "  --log-summary               One aggregated share line per log_interval\n";
     std::cout << "  -h, --help                  Show this help message\n\n";
     std::cout << "Note: Running without arguments will create a default config.yml file\n\n";
 }
@@ -240,6 +257,7 @@ int kbhit() {
 }
 
 int main(int argc, char* argv[]) {
+    auto launch_time = std::chrono::steady_clock::now();
     Config config;
     bool benchmark_mode = false;
     bool show_help = false;
@@ -256,6 +274,17 @@ int main(int argc, char* argv[]) {
     {"benchmark", no_argument, 0, 'b'},
     {"invisible", no_argument, 0, 'I'},
     {"nolog", no_argument, 0, 'n'},
+    {"log-summary", no_argument, 0, 'L'},
+    {"max-hashrate", required_argument, 0, 'M'},
+    {"affinity", required_argument, 0, 'A'},
+    {"max-workers", required_argument, 0, 'W'},
+    {"autoscale", no_argument, 0, 'a'},
+    {"trace", required_argument, 0, 'T'},
+    {"journal", required_argument, 0, 'J'},
+    {"perf", no_argument, 0, 'P'},
+    {"http-port", required_argument, 0, 'H'},
+    {"statsd", required_argument, 0, 'S'},
+    {"shm", required_argument, 0, 'm'},
     {"help", no_argument, 0, 'h'},
     {0, 0, 0, 0}
 };
@@ -277,8 +306,21 @@ while ((opt = getopt_long(argc, argv, "u:k:t:i:d:r:p:c:bInh", long_options, &opt
             std::string pool_str = optarg;
             size_t colon_pos = pool_str.find(':');
             if (colon_pos != std::string::npos) {
-                config.pool_address = pool_str.substr(0, colon_pos);
-                config.pool_port = std::stoi(pool_str.substr(colon_pos + 1));
+                // Repeat -p to shard threads across several pools,
+                // optionally weighted as host:port:weight
+                PoolConfig pool;
+                pool.address = pool_str.substr(0, colon_pos);
+                std::string rest = pool_str.substr(colon_pos + 1);
+                size_t weight_pos = rest.find(':');
+                pool.port = std::stoi(rest.substr(0, weight_pos));
+                if (weight_pos != std::string::npos) {
+                    pool.weight = std::stoi(rest.substr(weight_pos + 1));
+                }
+                if (config.pools.empty()) {
+                    config.pool_address = pool.address;
+                    config.pool_port = pool.port;
+                }
+                config.pools.push_back(pool);
             } else {
                 Logger::error("Invalid pool format. Use: host:port");
                 return 1;
@@ -292,6 +334,25 @@ while ((opt = getopt_long(argc, argv, "u:k:t:i:d:r:p:c:bInh", long_options, &opt
         case 'b': benchmark_mode = true; break;
         case 'I': config.invisible_mode = true; break;
         case 'n': Logger::disable(); break;
+        case 'L': config.log_mode = "summary"; break;
+        case 'M': config.max_hashrate = std::stod(optarg); break;
+        case 'A': config.affinity = optarg; break;
+        case 'W': config.max_workers = std::stoi(optarg); break;
+        case 'a': config.autoscale = true; break;
+        case 'T': config.trace_file = optarg; break;
+        case 'J': config.journal_file = optarg; break;
+        case 'P': config.perf_counters = true; break;
+        case 'H': config.http_port = std::stoi(optarg); break;
+        case 'm': config.shm_name = optarg; break;
+        case 'S': {
+            std::string target = optarg;
+            size_t colon = target.rfind(':');
+            config.statsd_host = target.substr(0, colon);
+            if (colon != std::string::npos) {
+                config.statsd_port = std::stoi(target.substr(colon + 1));
+            }
+            break;
+        }
         case 'h': show_help = true; break;
         default:
             print_usage(argv[0]);
@@ -339,15 +400,19 @@ while ((opt = getopt_long(argc, argv, "u:k:t:i:d:r:p:c:bInh", long_options, &opt
     }
 
     config.validate();
+    Logger::configure(config.log_mode == "summary", config.log_interval, config.log_rate);
 
     if (benchmark_mode) {
         Benchmark bench;
-        bench.run(config.threads);
+        bench.run(config.threads, config.perf_counters);
         return 0;
     }
 
     std::signal(SIGINT, signal_handler);
     std::signal(SIGTERM, signal_handler);
+    std::signal(SIGUSR1, signal_handler);  // pause
+    std::signal(SIGUSR2, signal_handler);  // resume
+    std::signal(SIGHUP, signal_handler);   // dump trace
 
     NetworkManager network;
     if (!network.initialize()) {
@@ -355,25 +420,63 @@ while ((opt = getopt_long(argc, argv, "u:k:t:i:d:r:p:c:bInh", long_options, &opt
         return 1;
     }
 
-    if (config.pool_address.empty()) {
-        if (!network.fetch_pool()) {
-            Logger::error("Failed to fetch mining pool");
-            return 1;
+    if (config.pools.empty()) {
+        network.set_cache(config.pool_cache, config.pool_cache_ttl);
+        if (network.load_cached_pool(false)) {
+            network.refresh_pool_async();
+        } else if (!network.fetch_pool()) {
+            if (!network.load_cached_pool(true)) {
+                Logger::error("Failed to fetch mining pool");
+                return 1;
+            }
+            Logger::warning("Pool picker unreachable, using stale cached pool");
         }
     } else {
-        Logger::info("Using custom pool: " + config.pool_address + ":" + 
-                     std::to_string(config.pool_port));
+        std::vector<PoolInfo> pools;
+        for (const auto& p : config.pools) {
+            Logger::info("Using custom pool: " + p.address + ":" + 
+                         std::to_string(p.port) +
+                         (config.pools.size() > 1 ? " (weight " + std::to_string(p.weight) + ")" : ""));
+            pools.push_back({p.address, p.port, p.address, p.weight});
+        }
+        network.set_pools(pools, config.pool_balance);
     }
 
     Miner miner(config, network);
+    miner.set_launch_time(launch_time);
     if (!miner.initialize()) {
         Logger::error("Failed to initialize miner");
         return 1;
     }
 
+    if (!config.trace_file.empty()) {
+        Trace::enable(config.trace_file, config.max_workers, config.trace_events);
+    }
+
     auto start_time = std::chrono::steady_clock::now();
     
+    Logger::start_writer();
     miner.start();
+    
+    SystemStats system;
+    system.start_time = start_time;
+    system.start_sampler(miner, config.sample_interval);
+    MetricsServer metrics(config, miner, system);
+    if (config.http_port > 0) {
+        metrics.start(config.http_host, config.http_port);
+    }
+    StatsdReporter statsd(config, miner);
+    if (!config.statsd_host.empty()) {
+        statsd.start(config.statsd_host, config.statsd_port);
+    }
+    ShmStatsPublisher shm(miner);
+    if (!config.shm_name.empty()) {
+        shm.start(config.shm_name, config.max_workers, config.shm_interval, config.rig_identifier);
+    }
+    Autoscaler autoscaler(config, miner, system);
+    if (config.autoscale) {
+        autoscaler.start();
+    }
 
     // Keyboard input thread
     std::thread input_thread([&]() {
@@ -388,34 +491,107 @@ while ((opt = getopt_long(argc, argv, "u:k:t:i:d:r:p:c:bInh", long_options, &opt
                     auto stats = miner.get_stats();
                     PoolInfo pool = network.get_pool();
                     
+                    Logger::begin_report();
                     Logger::print_stats(
                         stats.accepted,
                         stats.rejected,
                         stats.total_hashrate,
-                        config.threads,
+                        stats.workers,
                         uptime,
                         pool.ip,
                         pool.port,
                         stats.blocks
                     );
+                    Logger::io_stats(-1, stats.io.bytes_sent, stats.io.bytes_received,
+                                     stats.io.messages_sent, stats.io.messages_received,
+                                     stats.io.syscalls, stats.io.connects);
+                    std::vector<std::pair<std::string, double>> tiers;
+                    for (int t = 0; t < DIFF_TIER_COUNT; t++) {
+                        tiers.emplace_back(DifficultyController::tier_name(t),
+                                           stats.bytes_per_share[t]);
+                    }
+                    Logger::bytes_per_share(tiers);
+                    if (stats.nodes.size() > 1) {
+                        for (const NodeSnapshot& ns : stats.nodes) {
+                            Logger::node_stats(ns.node, ns.threads, ns.hashrate,
+                                               ns.accepted, ns.rejected);
+                        }
+                    }
+                    if (stats.classes[CORE_EFFICIENCY].threads > 0) {
+                        for (int c = 0; c < CORE_CLASS_COUNT; c++) {
+                            const ClassSnapshot& cs = stats.classes[c];
+                            Logger::class_stats(std::string(Topology::class_name(c)) + "-core",
+                                                cs.threads, cs.hashrate, cs.weight,
+                                                cs.difficulty, cs.kernel);
+                        }
+                    }
+                    CpuSample cpu = system.get_sample();
+                    Logger::cpu_usage(cpu.system_usage, cpu.pressure, cpu.process_usage,
+                                      cpu.hashes_per_cpu_second, cpu.throttled);
+                    
+                    if (stats.pools.size() > 1) {
+                        for (const auto& ps : stats.pools) {
+                            Logger::pool_update(ps.pool.ip, ps.pool.port, ps.workers,
+                                                ps.hashrate, ps.accepted, ps.rejected,
+                                                ps.rtt_ms);
+                            Logger::latency_stats(ps.job_rtt, ps.solve_time, ps.submit_rtt);
+                        }
+                    }
+                    
+                    if (stats.threads.size() > STATS_THREAD_DETAIL) {
+                        Logger::info("Per-thread detail for " +
+                                     std::to_string(stats.threads.size()) +
+                                     " threads is in /api/summary and duino-top");
+                    } else {
+                        for (size_t i = 0; i < stats.threads.size(); i++) {
+                            const auto& ts = stats.threads[i];
+                            double waiting = ts.ns_phase[PHASE_CONNECT] + ts.ns_phase[PHASE_JOB] +
+                                             ts.ns_phase[PHASE_SUBMIT];
+                            Logger::thread_stats(i, ts.hashrate_10s,
+                                                 DifficultyController::tier_name(ts.tier),
+                                                 ts.solve_ms, ts.useful_permille, ts.jobs,
+                                                 ts.ns_phase[PHASE_HASHING] / 1e9, waiting / 1e9);
+                        
+                            std::vector<std::pair<std::string, double>> phases;
+                            for (int p = 0; p < PHASE_COUNT; p++) {
+                                phases.emplace_back(Miner::phase_name(p), ts.ns_phase[p] / 1e9);
+                            }
+                            Logger::phase_breakdown(phases);
+                        
+                            if (ts.perf[PERF_CYCLES] > 0 && ts.hashes > 0) {
+                                Logger::perf_stats(
+                                    (double)ts.perf[PERF_CYCLES] / ts.hashes,
+                                    (double)ts.perf[PERF_INSTRUCTIONS] / ts.perf[PERF_CYCLES],
+                                    (double)ts.perf[PERF_BRANCH_MISSES] / ts.hashes,
+                                    (double)ts.perf[PERF_L1D_MISSES] / ts.hashes);
+                            }
+                            Logger::latency_stats(ts.job_rtt, ts.solve_time, ts.submit_rtt);
+                            if (i < cpu.thread_usage.size()) {
+                                Logger::thread_cpu(cpu.thread_usage[i], cpu.thread_cpu_seconds[i],
+                                                   cpu.thread_hashes_per_cpu_second[i]);
+                            }
+                            Logger::io_stats(i, ts.io.bytes_sent, ts.io.bytes_received,
+                                             ts.io.messages_sent, ts.io.messages_received,
+                                             ts.io.syscalls, ts.io.connects);
+                        }
+                    }
+                    Logger::end_report();
                 } else if (c == 'h' || c == 'H') {
                     auto stats = miner.get_stats();
                     Logger::speed_update(
-                        config.threads,
-                        stats.total_hashrate,
-                        stats.accepted,
-                        stats.rejected
+                        stats.hashrate_10s,
+                        stats.hashrate_60s,
+                        stats.hashrate_15m,
+                        stats.max_hashrate
                     );
+                } else if (c == '+' || c == '=') {
+                    miner.set_workers(miner.workers() + 1);
+                } else if (c == '-' || c == '_') {
+                    miner.set_workers(miner.workers() - 1);
                 } else if (c == 'p' || c == 'P') {
-                    if (!paused) {
-                        paused = true;
-                        Logger::warning("Mining paused");
-                    }
+                    pause_request = 1;
                 } else if (c == 'r' || c == 'R') {
-                    if (paused) {
-                        paused = false;
-                        Logger::success("Mining resumed");
-                    }
+                    pause_request = 2;
                 } else if (c == 'q' || c == 'Q') {
                     running = false;
                     Logger::info("Quit command received");
@@ -426,16 +602,34 @@ while ((opt = getopt_long(argc, argv, "u:k:t:i:d:r:p:c:bInh", long_options, &opt
     });
 
     while (running) {
-        std::this_thread::sleep_for(std::chrono::seconds(1));
+        int request = pause_request.exchange(0);
+        if (request == 1 && !miner.is_paused()) {
+            miner.pause();
+            Logger::warning("Mining paused");
+        } else if (request == 2 && miner.is_paused()) {
+            miner.resume();
+            Logger::success("Mining resumed");
+        }
+        if (trace_request.exchange(false)) {
+            Trace::dump();
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
     }
 
     Logger::info("Stopping miner gracefully");
+    autoscaler.stop();
+    metrics.stop();
+    statsd.stop();
+    shm.stop();
+    system.stop_sampler();
     miner.stop();
+    Trace::dump();
     
     if (input_thread.joinable()) {
         input_thread.join();
     }
     
     Logger::success("Miner stopped successfully");
+    Logger::stop_writer();
     return 0;
 }
\ No newline at end of file
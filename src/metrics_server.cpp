@@ -0,0 +1,553 @@
+#include "../include/metrics_server.h"
+#include "../include/logger.h"
+#include "../include/hasher.h"
+#include "../include/json.h"
+#include <sstream>
+#include <iomanip>
+#include <cstring>
+#include <unistd.h>
+#include <poll.h>
+#include <netdb.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+
+#define METRICS_MAX_REQUEST 8192
+#define METRICS_IO_TIMEOUT_MS 1000
+
+static std::string label(const std::string& value) {
+    std::string out;
+    for (char c : value) {
+        if (c == '\\' || c == '"') out += '\\';
+        if (c == '\n') { out += "\\n"; continue; }
+        out += c;
+    }
+    return out;
+}
+
+MetricsServer::MetricsServer(const Config& cfg, Miner& miner, const SystemStats& system)
+    : config(cfg), miner(miner), system(system) {}
+
+MetricsServer::~MetricsServer() {
+    stop();
+}
+
+bool MetricsServer::start(const std::string& host, int port) {
+    struct addrinfo hints, *res;
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    hints.ai_flags = AI_PASSIVE;
+
+    if (getaddrinfo(host.empty() ? nullptr : host.c_str(), std::to_string(port).c_str(),
+                    &hints, &res) != 0) {
+        Logger::error("Metrics: cannot resolve " + host);
+        return false;
+    }
+
+    for (struct addrinfo* p = res; p; p = p->ai_next) {
+        int fd = socket(p->ai_family, p->ai_socktype | SOCK_CLOEXEC, p->ai_protocol);
+        if (fd < 0) continue;
+        int yes = 1;
+        setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &yes, sizeof(yes));
+        if (bind(fd, p->ai_addr, p->ai_addrlen) == 0 && listen(fd, 16) == 0) {
+            listen_fd = fd;
+            break;
+        }
+        close(fd);
+    }
+    freeaddrinfo(res);
+
+    if (listen_fd < 0) {
+        Logger::error("Metrics: cannot listen on " + host + ":" + std::to_string(port) +
+                      ": " + strerror(errno));
+        return false;
+    }
+
+    running = true;
+    server_thread = std::thread(&MetricsServer::serve, this);
+    Logger::info("Metrics on http://" + host + ":" + std::to_string(port) +
+                 "/metrics and /api/summary");
+    return true;
+}
+
+void MetricsServer::stop() {
+    running = false;
+    if (server_thread.joinable()) {
+        server_thread.join();
+    }
+    if (listen_fd >= 0) {
+        close(listen_fd);
+        listen_fd = -1;
+    }
+}
+
+void MetricsServer::serve() {
+    while (running) {
+        struct pollfd pfd;
+        pfd.fd = listen_fd;
+        pfd.events = POLLIN;
+        if (poll(&pfd, 1, 200) <= 0) continue;
+
+        int client = accept4(listen_fd, nullptr, nullptr, SOCK_CLOEXEC);
+        if (client < 0) continue;
+
+        struct timeval tv;
+        tv.tv_sec = METRICS_IO_TIMEOUT_MS / 1000;
+        tv.tv_usec = (METRICS_IO_TIMEOUT_MS % 1000) * 1000;
+        setsockopt(client, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+        setsockopt(client, SOL_SOCKET, SO_SNDTIMEO, &tv, sizeof(tv));
+
+        handle(client);
+        close(client);
+    }
+}
+
+void MetricsServer::handle(int client_fd) {
+    std::string request;
+    char buffer[1024];
+    while (request.find("\r\n\r\n") == std::string::npos &&
+           request.length() < METRICS_MAX_REQUEST) {
+        ssize_t n = recv(client_fd, buffer, sizeof(buffer), 0);
+        if (n <= 0) return;
+        request.append(buffer, n);
+    }
+
+    // GET /path HTTP/1.1
+    std::string method, path, query;
+    std::istringstream line(request.substr(0, request.find("\r\n")));
+    line >> method >> path;
+    size_t mark = path.find('?');
+    if (mark != std::string::npos) {
+        query = path.substr(mark + 1);
+        path = path.substr(0, mark);
+    }
+
+    int status = 200;
+    std::string content_type = "text/plain; version=0.0.4; charset=utf-8";
+    std::string body;
+
+    if (method == "POST" && path == "/api/workers") {
+        status = config.http_control ? scale_workers(query) : 403;
+        if (status == 200) {
+            content_type = "application/json";
+            body = render_workers();
+        } else {
+            body = status == 403 ? "worker control disabled (http_control)\n"
+                                 : "expected count=N or delta=N\n";
+        }
+    } else if (method != "GET" && method != "HEAD") {
+        status = 405;
+        body = "method not allowed\n";
+    } else if (path == "/metrics") {
+        body = render_prometheus();
+    } else if (path == "/api/summary" || path == "/1/summary") {
+        content_type = "application/json";
+        body = render_summary();
+    } else if (path == "/api/workers") {
+        content_type = "application/json";
+        body = render_workers();
+    } else {
+        status = 404;
+        body = "not found\n";
+    }
+
+    std::ostringstream response;
+    response << "HTTP/1.1 " << status << " "
+             << (status == 200 ? "OK" : status == 400 ? "Bad Request" :
+                 status == 403 ? "Forbidden" : status == 404 ? "Not Found" :
+                 "Method Not Allowed")
+             << "\r\nContent-Type: " << content_type
+             << "\r\nContent-Length: " << body.length()
+             << "\r\nConnection: close\r\n\r\n";
+    if (method != "HEAD") response << body;
+
+    std::string out = response.str();
+    size_t sent = 0;
+    while (sent < out.length()) {
+        ssize_t n = send(client_fd, out.c_str() + sent, out.length() - sent, MSG_NOSIGNAL);
+        if (n <= 0) return;
+        sent += n;
+    }
+}
+
+int MetricsServer::scale_workers(const std::string& query) {
+    // count=N sets the worker count, delta=N adds or (negative) retires
+    size_t eq = query.find('=');
+    if (eq == std::string::npos) return 400;
+    std::string key = query.substr(0, eq);
+    std::string value = query.substr(eq + 1, query.find('&') - eq - 1);
+    int n;
+    try {
+        size_t used;
+        n = std::stoi(value, &used);
+        if (used != value.length()) return 400;
+    } catch (...) {
+        return 400;
+    }
+    if (key == "count") {
+        miner.set_workers(n);
+    } else if (key == "delta") {
+        miner.set_workers(miner.workers() + n);
+    } else {
+        return 400;
+    }
+    return 200;
+}
+
+std::string MetricsServer::render_workers() const {
+    return "{\"workers\":" + std::to_string(miner.workers()) +
+           ",\"max_workers\":" + std::to_string(miner.max_workers()) + "}\n";
+}
+
+std::string MetricsServer::render_prometheus() const {
+    MiningStatsSnapshot stats = miner.get_stats();
+    CpuSample cpu = system.get_sample();
+    double uptime = std::chrono::duration<double>(
+        std::chrono::steady_clock::now() - system.start_time).count();
+
+    std::ostringstream out;
+    out << std::setprecision(10);
+
+    auto header = [&](const char* name, const char* type, const char* help) {
+        out << "# HELP " << name << " " << help << "\n"
+            << "# TYPE " << name << " " << type << "\n";
+    };
+    auto summary = [&](const char* name, const std::string& labels,
+                       const HistogramSummary& h, double scale) {
+        out << name << "{" << labels << ",quantile=\"0.5\"} " << h.p50_ms / scale << "\n"
+            << name << "{" << labels << ",quantile=\"0.9\"} " << h.p90_ms / scale << "\n"
+            << name << "{" << labels << ",quantile=\"0.99\"} " << h.p99_ms / scale << "\n"
+            << name << "_sum{" << labels << "} " << h.mean_ms * h.count / scale << "\n"
+            << name << "_count{" << labels << "} " << h.count << "\n";
+    };
+
+    header("duino_info", "gauge", "Miner build and host");
+    out << "duino_info{version=\"" VERSION "\",kernel=\"" << Hasher::kernel_name()
+        << "\",rig=\"" << label(config.rig_identifier)
+        << "\",cpu=\"" << label(system.get_cpu_name()) << "\"} 1\n";
+
+    header("duino_uptime_seconds", "gauge", "Seconds since start");
+    out << "duino_uptime_seconds " << uptime << "\n";
+    header("duino_paused", "gauge", "1 while workers are parked");
+    out << "duino_paused " << (miner.is_paused() ? 1 : 0) << "\n";
+    header("duino_threads", "gauge", "Worker threads");
+    out << "duino_threads " << stats.threads.size() << "\n";
+    header("duino_workers", "gauge", "Workers the miner is scaled to");
+    out << "duino_workers " << stats.workers << "\n";
+    header("duino_max_workers", "gauge", "Ceiling for runtime scaling");
+    out << "duino_max_workers " << stats.max_workers << "\n";
+
+    header("duino_hashrate", "gauge", "Hashes per second, moving average");
+    out << "duino_hashrate{window=\"10s\"} " << stats.hashrate_10s << "\n"
+        << "duino_hashrate{window=\"60s\"} " << stats.hashrate_60s << "\n"
+        << "duino_hashrate{window=\"15m\"} " << stats.hashrate_15m << "\n";
+    header("duino_hashrate_max", "gauge", "Highest 10s hashrate seen");
+    out << "duino_hashrate_max " << stats.max_hashrate << "\n";
+
+    header("duino_shares_total", "counter", "Share verdicts");
+    out << "duino_shares_total{result=\"accepted\"} " << stats.accepted << "\n"
+        << "duino_shares_total{result=\"rejected\"} " << stats.rejected << "\n";
+    header("duino_blocks_total", "counter", "Shares answered with BLOCK");
+    out << "duino_blocks_total " << stats.blocks << "\n";
+    header("duino_log_dropped_total", "counter", "Log records dropped on a full queue");
+    out << "duino_log_dropped_total " << Logger::dropped() << "\n";
+
+    header("duino_system_cpu_percent", "gauge", "Busy share of all CPUs");
+    out << "duino_system_cpu_percent " << cpu.system_usage << "\n";
+    if (cpu.pressure >= 0) {
+        header("duino_cpu_pressure_percent", "gauge", "Wall time with runnable tasks waiting for a CPU");
+        out << "duino_cpu_pressure_percent " << cpu.pressure << "\n";
+    }
+    if (cpu.throttled >= 0) {
+        header("duino_cgroup_throttled_percent", "gauge", "Cgroup CPU quota periods that ran out of quota");
+        out << "duino_cgroup_throttled_percent " << cpu.throttled << "\n";
+    }
+    header("duino_cgroup_throttled_periods_total", "counter", "Cgroup cpu.stat nr_throttled");
+    out << "duino_cgroup_throttled_periods_total " << cpu.throttled_periods << "\n";
+    header("duino_cgroup_throttled_seconds_total", "counter", "Cgroup cpu.stat throttled time");
+    out << "duino_cgroup_throttled_seconds_total " << cpu.throttled_seconds << "\n";
+    header("duino_usable_cpus", "gauge", "CPUs left by the affinity mask, cpuset and CPU quota");
+    out << "duino_usable_cpus " << miner.cpu_limits().usable_cpus() << "\n";
+    header("duino_process_cpu_percent", "gauge", "Miner CPU usage, 100 per busy core");
+    out << "duino_process_cpu_percent " << cpu.process_usage << "\n";
+    header("duino_hashes_per_cpu_second", "gauge", "Hashes per second of miner CPU time");
+    out << "duino_hashes_per_cpu_second " << cpu.hashes_per_cpu_second << "\n";
+
+    header("duino_net_bytes_total", "counter", "Socket bytes, all connections");
+    out << "duino_net_bytes_total{direction=\"sent\"} " << stats.io.bytes_sent << "\n"
+        << "duino_net_bytes_total{direction=\"received\"} " << stats.io.bytes_received << "\n";
+    header("duino_net_messages_total", "counter", "Protocol lines, all connections");
+    out << "duino_net_messages_total{direction=\"sent\"} " << stats.io.messages_sent << "\n"
+        << "duino_net_messages_total{direction=\"received\"} " << stats.io.messages_received << "\n";
+    header("duino_net_syscalls_total", "counter", "Socket system calls");
+    out << "duino_net_syscalls_total " << stats.io.syscalls << "\n";
+    header("duino_net_connects_total", "counter", "Successful connects, including reconnects");
+    out << "duino_net_connects_total " << stats.io.connects << "\n";
+    header("duino_bytes_per_share", "gauge", "Pool traffic per accepted share by difficulty tier");
+    for (int t = 0; t < DIFF_TIER_COUNT; t++) {
+        out << "duino_bytes_per_share{tier=\"" << DifficultyController::tier_name(t) << "\"} "
+            << stats.bytes_per_share[t] << "\n";
+    }
+
+    header("duino_node_hashrate", "gauge", "10s hashrate of the workers on each NUMA node");
+    for (const NodeSnapshot& ns : stats.nodes) {
+        out << "duino_node_hashrate{node=\"" << ns.node << "\"} " << ns.hashrate << "\n";
+    }
+    header("duino_node_threads", "gauge", "Worker threads per NUMA node");
+    for (const NodeSnapshot& ns : stats.nodes) {
+        out << "duino_node_threads{node=\"" << ns.node << "\"} " << ns.threads << "\n";
+    }
+    header("duino_node_shares_total", "counter", "Shares per NUMA node by result");
+    for (const NodeSnapshot& ns : stats.nodes) {
+        out << "duino_node_shares_total{node=\"" << ns.node << "\",result=\"accepted\"} "
+            << ns.accepted << "\n"
+            << "duino_node_shares_total{node=\"" << ns.node << "\",result=\"rejected\"} "
+            << ns.rejected << "\n";
+    }
+
+    header("duino_class_hashrate", "gauge", "10s hashrate per core class (P/E on hybrid CPUs)");
+    for (int c = 0; c < CORE_CLASS_COUNT; c++) {
+        out << "duino_class_hashrate{class=\"" << Topology::class_name(c) << "\"} "
+            << stats.classes[c].hashrate << "\n";
+    }
+    header("duino_class_threads", "gauge", "Worker threads per core class");
+    for (int c = 0; c < CORE_CLASS_COUNT; c++) {
+        out << "duino_class_threads{class=\"" << Topology::class_name(c) << "\"} "
+            << stats.classes[c].threads << "\n";
+    }
+
+    header("duino_thread_hashrate", "gauge", "Per-thread hashes per second");
+    for (size_t i = 0; i < stats.threads.size(); i++) {
+        const ThreadSnapshot& t = stats.threads[i];
+        out << "duino_thread_hashrate{thread=\"" << i << "\",window=\"10s\"} " << t.hashrate_10s << "\n"
+            << "duino_thread_hashrate{thread=\"" << i << "\",window=\"60s\"} " << t.hashrate_60s << "\n"
+            << "duino_thread_hashrate{thread=\"" << i << "\",window=\"15m\"} " << t.hashrate_15m << "\n";
+    }
+    header("duino_thread_hashes_total", "counter", "Hashes computed per thread");
+    for (size_t i = 0; i < stats.threads.size(); i++) {
+        out << "duino_thread_hashes_total{thread=\"" << i << "\"} " << stats.threads[i].hashes << "\n";
+    }
+    header("duino_thread_jobs_total", "counter", "Jobs received per thread");
+    for (size_t i = 0; i < stats.threads.size(); i++) {
+        out << "duino_thread_jobs_total{thread=\"" << i << "\"} " << stats.threads[i].jobs << "\n";
+    }
+    header("duino_thread_cpu_seconds_total", "counter", "CPU time per worker thread");
+    for (size_t i = 0; i < cpu.thread_cpu_seconds.size(); i++) {
+        out << "duino_thread_cpu_seconds_total{thread=\"" << i << "\"} "
+            << cpu.thread_cpu_seconds[i] << "\n";
+    }
+    header("duino_thread_hashes_per_cpu_second", "gauge", "Hashes per second of the worker's CPU time");
+    for (size_t i = 0; i < cpu.thread_hashes_per_cpu_second.size(); i++) {
+        out << "duino_thread_hashes_per_cpu_second{thread=\"" << i << "\"} "
+            << cpu.thread_hashes_per_cpu_second[i] << "\n";
+    }
+    header("duino_thread_net_bytes_total", "counter", "Pool traffic per thread");
+    for (size_t i = 0; i < stats.threads.size(); i++) {
+        out << "duino_thread_net_bytes_total{thread=\"" << i << "\",direction=\"sent\"} "
+            << stats.threads[i].io.bytes_sent << "\n"
+            << "duino_thread_net_bytes_total{thread=\"" << i << "\",direction=\"received\"} "
+            << stats.threads[i].io.bytes_received << "\n";
+    }
+    header("duino_thread_net_syscalls_total", "counter", "Socket system calls per thread");
+    for (size_t i = 0; i < stats.threads.size(); i++) {
+        out << "duino_thread_net_syscalls_total{thread=\"" << i << "\"} "
+            << stats.threads[i].io.syscalls << "\n";
+    }
+    header("duino_thread_net_connects_total", "counter", "Successful connects per thread");
+    for (size_t i = 0; i < stats.threads.size(); i++) {
+        out << "duino_thread_net_connects_total{thread=\"" << i << "\"} "
+            << stats.threads[i].io.connects << "\n";
+    }
+    header("duino_thread_difficulty", "gauge", "Difficulty tier per thread");
+    for (size_t i = 0; i < stats.threads.size(); i++) {
+        out << "duino_thread_difficulty{thread=\"" << i << "\",tier=\""
+            << DifficultyController::tier_name(stats.threads[i].tier) << "\"} 1\n";
+    }
+    header("duino_thread_phase_seconds_total", "counter", "Wall time per mining loop phase");
+    for (size_t i = 0; i < stats.threads.size(); i++) {
+        for (int p = 0; p < PHASE_COUNT; p++) {
+            out << "duino_thread_phase_seconds_total{thread=\"" << i << "\",phase=\""
+                << Miner::phase_name(p) << "\"} " << stats.threads[i].ns_phase[p] / 1e9 << "\n";
+        }
+    }
+    if (config.perf_counters) {
+        header("duino_thread_perf_events_total", "counter", "Hardware events while hashing");
+        for (size_t i = 0; i < stats.threads.size(); i++) {
+            for (int e = 0; e < PERF_EVENT_COUNT; e++) {
+                out << "duino_thread_perf_events_total{thread=\"" << i << "\",event=\""
+                    << PerfCounters::event_name(e) << "\"} " << stats.threads[i].perf[e] << "\n";
+            }
+        }
+    }
+
+    header("duino_thread_job_rtt_seconds", "summary", "JOB request round trip per thread");
+    for (size_t i = 0; i < stats.threads.size(); i++) {
+        summary("duino_thread_job_rtt_seconds", "thread=\"" + std::to_string(i) + "\"",
+                stats.threads[i].job_rtt, 1000.0);
+    }
+    header("duino_thread_solve_seconds", "summary", "Time to solution per thread");
+    for (size_t i = 0; i < stats.threads.size(); i++) {
+        summary("duino_thread_solve_seconds", "thread=\"" + std::to_string(i) + "\"",
+                stats.threads[i].solve_time, 1000.0);
+    }
+    header("duino_thread_submit_rtt_seconds", "summary", "Share verdict latency per thread");
+    for (size_t i = 0; i < stats.threads.size(); i++) {
+        summary("duino_thread_submit_rtt_seconds", "thread=\"" + std::to_string(i) + "\"",
+                stats.threads[i].submit_rtt, 1000.0);
+    }
+
+    auto pool_label = [](const PoolSnapshot& p) {
+        return "pool=\"" + label(p.pool.ip) + ":" + std::to_string(p.pool.port) + "\"";
+    };
+    header("duino_pool_workers", "gauge", "Threads assigned to the pool");
+    for (const auto& p : stats.pools) {
+        out << "duino_pool_workers{" << pool_label(p) << "} " << p.workers << "\n";
+    }
+    header("duino_pool_hashrate", "gauge", "10s hashrate of the threads on the pool");
+    for (const auto& p : stats.pools) {
+        out << "duino_pool_hashrate{" << pool_label(p) << "} " << p.hashrate << "\n";
+    }
+    header("duino_pool_shares_total", "counter", "Share verdicts per pool");
+    for (const auto& p : stats.pools) {
+        out << "duino_pool_shares_total{" << pool_label(p) << ",result=\"accepted\"} " << p.accepted << "\n"
+            << "duino_pool_shares_total{" << pool_label(p) << ",result=\"rejected\"} " << p.rejected << "\n"
+            << "duino_pool_shares_total{" << pool_label(p) << ",result=\"block\"} " << p.blocks << "\n";
+    }
+    header("duino_pool_job_rtt_seconds", "summary", "JOB request round trip per pool");
+    for (const auto& p : stats.pools) {
+        summary("duino_pool_job_rtt_seconds", pool_label(p), p.job_rtt, 1000.0);
+    }
+    header("duino_pool_solve_seconds", "summary", "Time to solution per pool");
+    for (const auto& p : stats.pools) {
+        summary("duino_pool_solve_seconds", pool_label(p), p.solve_time, 1000.0);
+    }
+    header("duino_pool_submit_rtt_seconds", "summary", "Share verdict latency per pool");
+    for (const auto& p : stats.pools) {
+        summary("duino_pool_submit_rtt_seconds", pool_label(p), p.submit_rtt, 1000.0);
+    }
+
+    return out.str();
+}
+
+std::string MetricsServer::render_summary() const {
+    MiningStatsSnapshot stats = miner.get_stats();
+    CpuSample cpu = system.get_sample();
+    double uptime = std::chrono::duration<double>(
+        std::chrono::steady_clock::now() - system.start_time).count();
+
+    std::ostringstream out;
+    out << std::fixed << std::setprecision(2);
+
+    auto histogram = [&](const HistogramSummary& h) {
+        out << "{\"count\":" << h.count << ",\"mean_ms\":" << h.mean_ms
+            << ",\"p50_ms\":" << h.p50_ms << ",\"p90_ms\":" << h.p90_ms
+            << ",\"p99_ms\":" << h.p99_ms << ",\"max_ms\":" << h.max_ms << "}";
+    };
+
+    out << "{\"version\":\"" VERSION "\""
+        << ",\"kernel\":" << Json::quote(Hasher::kernel_name())
+        << ",\"rig\":" << Json::quote(config.rig_identifier)
+        << ",\"cpu\":" << Json::quote(system.get_cpu_name())
+        << ",\"uptime\":" << (long)uptime
+        << ",\"paused\":" << (miner.is_paused() ? "true" : "false")
+        << ",\"workers\":" << stats.workers << ",\"max_workers\":" << stats.max_workers
+        << ",\"hashrate\":{\"total\":[" << stats.hashrate_10s << "," << stats.hashrate_60s
+        << "," << stats.hashrate_15m << "],\"highest\":" << stats.max_hashrate << "}"
+        << ",\"results\":{\"accepted\":" << stats.accepted << ",\"rejected\":" << stats.rejected
+        << ",\"blocks\":" << stats.blocks << "}";
+
+    out << ",\"cpu\":{\"system\":" << cpu.system_usage << ",\"pressure\":" << cpu.pressure
+        << ",\"process\":" << cpu.process_usage
+        << ",\"hashes_per_cpu_second\":" << cpu.hashes_per_cpu_second
+        << ",\"usable\":" << miner.cpu_limits().usable_cpus()
+        << ",\"quota\":" << miner.cpu_limits().quota
+        << ",\"throttled\":" << cpu.throttled
+        << ",\"throttled_periods\":" << cpu.throttled_periods
+        << ",\"throttled_seconds\":" << cpu.throttled_seconds << "}";
+
+    auto io = [&](const IoSnapshot& s) {
+        out << "{\"bytes_sent\":" << s.bytes_sent << ",\"bytes_received\":" << s.bytes_received
+            << ",\"messages_sent\":" << s.messages_sent
+            << ",\"messages_received\":" << s.messages_received
+            << ",\"syscalls\":" << s.syscalls << ",\"connects\":" << s.connects;
+    };
+    out << ",\"net\":";
+    io(stats.io);
+    out << ",\"bytes_per_share\":{";
+    for (int t = 0; t < DIFF_TIER_COUNT; t++) {
+        out << (t ? "," : "") << "\"" << DifficultyController::tier_name(t) << "\":"
+            << stats.bytes_per_share[t];
+    }
+    out << "}}";
+
+    out << ",\"nodes\":[";
+    for (size_t n = 0; n < stats.nodes.size(); n++) {
+        const NodeSnapshot& ns = stats.nodes[n];
+        out << (n ? "," : "") << "{\"node\":" << ns.node << ",\"threads\":" << ns.threads
+            << ",\"hashrate\":" << ns.hashrate << ",\"accepted\":" << ns.accepted
+            << ",\"rejected\":" << ns.rejected << ",\"blocks\":" << ns.blocks << "}";
+    }
+    out << "]";
+
+    out << ",\"classes\":{";
+    for (int c = 0; c < CORE_CLASS_COUNT; c++) {
+        const ClassSnapshot& cs = stats.classes[c];
+        out << (c ? "," : "") << "\"" << Topology::class_name(c) << "\":{\"threads\":"
+            << cs.threads << ",\"hashrate\":" << cs.hashrate << ",\"weight\":" << cs.weight
+            << ",\"difficulty\":\"" << cs.difficulty << "\",\"kernel\":\"" << cs.kernel << "\"}";
+    }
+    out << "}";
+
+    out << ",\"threads\":[";
+    for (size_t i = 0; i < stats.threads.size(); i++) {
+        const ThreadSnapshot& t = stats.threads[i];
+        out << (i ? "," : "") << "{\"id\":" << i
+            << ",\"hashrate\":[" << t.hashrate_10s << "," << t.hashrate_60s << ","
+            << t.hashrate_15m << "]"
+            << ",\"pool\":" << t.pool
+            << ",\"class\":\"" << Topology::class_name(t.core_class) << "\""
+            << ",\"state\":\"" << Miner::state_name(t.state) << "\""
+            << ",\"tier\":\"" << DifficultyController::tier_name(t.tier) << "\""
+            << ",\"hashes\":" << t.hashes << ",\"jobs\":" << t.jobs
+            << ",\"phases\":{";
+        for (int p = 0; p < PHASE_COUNT; p++) {
+            out << (p ? "," : "") << "\"" << Miner::phase_name(p) << "\":"
+                << t.ns_phase[p] / 1e9;
+        }
+        out << "},\"job_rtt\":";
+        histogram(t.job_rtt);
+        out << ",\"solve\":";
+        histogram(t.solve_time);
+        out << ",\"submit_rtt\":";
+        histogram(t.submit_rtt);
+        if (i < cpu.thread_usage.size()) {
+            out << ",\"cpu\":{\"usage\":" << cpu.thread_usage[i]
+                << ",\"seconds\":" << cpu.thread_cpu_seconds[i]
+                << ",\"hashes_per_cpu_second\":" << cpu.thread_hashes_per_cpu_second[i] << "}";
+        }
+        out << ",\"net\":";
+        io(t.io);
+        out << "}}";
+    }
+    out << "]";
+
+    out << ",\"pools\":[";
+    for (size_t i = 0; i < stats.pools.size(); i++) {
+        const PoolSnapshot& p = stats.pools[i];
+        out << (i ? "," : "") << "{\"address\":" << Json::quote(p.pool.ip)
+            << ",\"port\":" << p.pool.port << ",\"workers\":" << p.workers
+            << ",\"hashrate\":" << p.hashrate << ",\"accepted\":" << p.accepted
+            << ",\"rejected\":" << p.rejected << ",\"blocks\":" << p.blocks
+            << ",\"job_rtt\":";
+        histogram(p.job_rtt);
+        out << ",\"solve\":";
+        histogram(p.solve_time);
+        out << ",\"submit_rtt\":";
+        histogram(p.submit_rtt);
+        out << "}";
+    }
+    out << "]}\n";
+
+    return out.str();
+}
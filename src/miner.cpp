@@ -1,13 +1,19 @@
 #include "../include/miner.h"
 #include "../include/hasher.h"
 #include "../include/logger.h"
+#include "../include/throttle.h"
+#include "../include/trace.h"
 #include <chrono>
 #include <sstream>
+#include <iomanip>
 #include <mutex>
 #include <thread>
 #include <cstring>
 #include <algorithm>
+#include <cmath>
 #include <openssl/sha.h>
+#include <unistd.h>
+#include <sys/syscall.h>
 
 namespace OptimizedHasher {
     inline void fast_uint_to_str(unsigned long num, char* buffer, int& len) {
@@ -42,57 +48,271 @@ namespace OptimizedHasher {
     }
 }
 
+namespace {
+
+// Charges wall time to the phase the worker entered last: one clock read per
+// phase switch, published with the slot's single-writer adds. Each phase is
+// also a span on the trace timeline when tracing is on, and hardware counters
+// (if opened) are read at the edges of the hashing phase.
+class PhaseClock {
+private:
+    WorkerStats& ws;
+    int thread_id;
+    int current;
+    int64_t since;
+    const PerfCounters* perf = nullptr;
+    PerfSample perf_start;
+
+public:
+    PhaseClock(WorkerStats& ws, int thread_id, int phase)
+        : ws(ws), thread_id(thread_id), current(phase), since(Throttle::wall_ns()) {}
+
+    void set_perf(const PerfCounters* counters) { perf = counters; }
+
+    int64_t enter(int phase) {
+        int64_t now = Throttle::wall_ns();
+        WorkerStats::add(ws.ns_phase[current], now - since);
+        Trace::complete(thread_id, Miner::phase_name(current), since, now);
+        
+        if (perf && (current == PHASE_HASHING || phase == PHASE_HASHING)) {
+            PerfSample sample;
+            if (perf->read(sample)) {
+                if (current == PHASE_HASHING) {
+                    for (int i = 0; i < PERF_EVENT_COUNT; i++) {
+                        WorkerStats::add(ws.perf[i], sample.value[i] - perf_start.value[i]);
+                    }
+                }
+                perf_start = sample;
+            }
+        }
+        
+        if (phase != current) {
+            ws.phase.store(phase, std::memory_order_relaxed);
+        }
+        current = phase;
+        since = now;
+        return now;
+    }
+};
+
+}
+
 Miner::Miner(const Config& cfg, NetworkManager& net) 
-    : config(cfg), network(net) {
-    stats.thread_hashrates.resize(cfg.threads, 0.0);
+    : config(cfg), network(net), launch_time(std::chrono::steady_clock::now()) {
+    // Every slot runtime scaling may use is allocated up front, so readers
+    // never see the arrays move
+    int slots = std::max(cfg.max_workers, cfg.threads);
+    stats.workers.reset(new WorkerStats[slots]);
+    stats.latency.reset(new WorkerLatency[slots]);
+    stats.windows.reset(new HashrateWindows[slots]);
+    stats.nodes.reset(new NodeStats[1]);
+    stats.node_ids = {0};
+    stats.worker_count = slots;
+    sampled_hashes.assign(slots, 0);
+    threads.resize(slots);
+    pool_position.reset(new std::atomic<double>[slots]);
+    layout_pools(cfg.threads);
+    target = cfg.threads;
+    int start_tier = DifficultyController(cfg.start_diff).get_tier();
+    for (int i = 0; i < slots; i++) {
+        stats.workers[i].tier = start_tier;
+    }
 }
 
 Miner::~Miner() {
     stop();
 }
 
+// One tier below: E-cores take about twice as long per hash
+static std::string lower_tier(const std::string& diff) {
+    if (diff == "NET") return "MEDIUM";
+    if (diff == "MEDIUM") return "LOW";
+    return diff;
+}
+
+void Miner::setup_classes() {
+    class_diff[CORE_PERFORMANCE] = config.start_diff;
+    class_diff[CORE_EFFICIENCY] = config.efficiency_diff.empty() ?
+        lower_tier(config.start_diff) : config.efficiency_diff;
+    class_kernel_name[CORE_PERFORMANCE] = config.kernel;
+    class_kernel_name[CORE_EFFICIENCY] = config.efficiency_kernel;
+    class_weight[CORE_PERFORMANCE] = 1.0;
+    class_weight[CORE_EFFICIENCY] = config.efficiency_weight;
+    if (class_weight[CORE_EFFICIENCY] <= 0) {
+        // cpu_capacity when the kernel reports it, else a typical E-core
+        double capacity = topology.relative_capacity(CORE_EFFICIENCY);
+        class_weight[CORE_EFFICIENCY] = capacity > 0 ? capacity : 0.5;
+    }
+    for (int c = 0; c < CORE_CLASS_COUNT; c++) {
+        class_kernel[c] = Hasher::compare_kernel(class_kernel_name[c]);
+        if (!class_kernel[c]) {
+            Logger::warning(std::string("Compare kernel ") + class_kernel_name[c] +
+                            " not available on " + Topology::class_name(c) +
+                            "-cores, using auto");
+            class_kernel_name[c] = "auto";
+            class_kernel[c] = Hasher::compare_kernel("auto");
+        }
+    }
+    
+    // Unpinned workers count as performance cores
+    int count[CORE_CLASS_COUNT] = {};
+    for (int i = 0; i < stats.worker_count; i++) {
+        const CpuInfo* cpu = i < (int)worker_cpus.size() ? topology.find(worker_cpus[i]) : nullptr;
+        int core_class = cpu ? cpu->core_class : CORE_PERFORMANCE;
+        stats.workers[i].core_class.store(core_class, std::memory_order_relaxed);
+        stats.workers[i].tier = DifficultyController(class_diff[core_class]).get_tier();
+        if (i < config.threads) count[core_class]++;
+    }
+    layout_pools(config.threads);
+    
+    if (count[CORE_EFFICIENCY] > 0) {
+        std::ostringstream ss;
+        ss << std::fixed << std::setprecision(2) << "Hybrid CPU: ";
+        for (int c = 0; c < CORE_CLASS_COUNT; c++) {
+            ss << (c ? ", " : "") << count[c] << " " << Topology::class_name(c)
+               << "-core workers (diff " << class_diff[c] << ", kernel "
+               << class_kernel_name[c] << ", weight " << class_weight[c] << ")";
+        }
+        Logger::info(ss.str());
+    }
+}
+
+// Positions in [0, 1) for the first count slots, each sized by its class
+// weight, so weighted sharding splits the work rather than the threads
+void Miner::layout_pools(int count) {
+    double total = 0.0;
+    for (int i = 0; i < count; i++) {
+        total += class_weight[stats.workers[i].core_class.load(std::memory_order_relaxed)];
+    }
+    double acc = 0.0;
+    for (int i = 0; i < count; i++) {
+        double weight = class_weight[stats.workers[i].core_class.load(std::memory_order_relaxed)];
+        pool_position[i].store((acc + weight / 2) / total, std::memory_order_relaxed);
+        acc += weight;
+    }
+}
+
+// This worker's part of max_hashrate among the running workers
+double Miner::hashrate_cap(int core_class) const {
+    double cap = config.max_hashrate_thread;
+    if (config.max_hashrate > 0) {
+        double total = 0.0;
+        int count = target.load(std::memory_order_relaxed);
+        for (int i = 0; i < count; i++) {
+            total += class_weight[stats.workers[i].core_class.load(std::memory_order_relaxed)];
+        }
+        double share = config.max_hashrate * class_weight[core_class] / std::max(total, 1e-9);
+        cap = cap > 0 ? std::min(cap, share) : share;
+    }
+    return cap;
+}
+
+// One NodeStats per NUMA node that has a worker slot, allocated before the
+// workers start
+void Miner::setup_nodes() {
+    std::vector<int> ids;
+    for (int cpu : worker_cpus) {
+        const CpuInfo* info = topology.find(cpu);
+        int node = info ? info->node : 0;
+        if (std::find(ids.begin(), ids.end(), node) == ids.end()) ids.push_back(node);
+    }
+    if (ids.empty()) ids.push_back(0);
+    std::sort(ids.begin(), ids.end());
+    
+    stats.nodes.reset(new NodeStats[ids.size()]);
+    stats.node_ids = ids;
+    for (int i = 0; i < stats.worker_count; i++) {
+        const CpuInfo* info = i < (int)worker_cpus.size() ? topology.find(worker_cpus[i]) : nullptr;
+        int index = info ? std::find(ids.begin(), ids.end(), info->node) - ids.begin() : 0;
+        stats.workers[i].node.store(index, std::memory_order_relaxed);
+    }
+}
+
 bool Miner::initialize() {
+    if (!topology.load(config.sysfs_root)) {
+        Logger::warning("No CPU topology in sysfs, assuming one core per CPU");
+    }
+    limits.load(config.sysfs_root);
+    topology.restrict(limits);
+    Logger::info("CPU limits: " + limits.describe());
+    if (config.threads > limits.usable_cpus()) {
+        Logger::warning(std::to_string(config.threads) + " workers on " +
+                        std::to_string(limits.usable_cpus()) +
+                        " usable CPUs, they will be throttled or share cores");
+    }
+    // Slot i keeps its CPU across retire and re-add; placement order puts
+    // the preferred CPUs first, so the lowest slots get them
+    worker_cpus = topology.place(config.affinity, stats.worker_count);
+    Logger::info("CPU topology: " + topology.describe());
+    setup_classes();
+    setup_nodes();
+    if (!worker_cpus.empty()) {
+        // Threads started from here on (journal, logger, reporter, metrics)
+        // inherit this mask and stay off the starting workers' cores
+        std::vector<int> running(worker_cpus.begin(), worker_cpus.begin() + config.threads);
+        std::vector<int> spare = topology.spare(running);
+        Logger::info("Workers on CPUs " + Topology::format_list(running) + " (" +
+                     config.affinity + ")" +
+                     (spare.empty() ? "" : ", other threads on " + Topology::format_list(spare)));
+        if (!spare.empty() && !Topology::pin(pthread_self(), spare)) {
+            Logger::warning("Cannot move auxiliary threads off the hashing cores");
+        }
+    }
+    
+    // A journal that cannot be opened is logged and mining goes on
+    if (!config.journal_file.empty()) {
+        journal.open(config.journal_file, (uint64_t)config.journal_max_mb << 20,
+                     config.journal_keep, config.journal_fsync);
+    }
     return true;
 }
 
 void Miner::start() {
     running = true;
-    
-    for (int i = 0; i < config.threads; i++) {
-        threads.push_back(std::make_unique<std::thread>(
-            &Miner::mining_thread, this, i));
-#ifdef __linux__
-        cpu_set_t cpuset;
-        CPU_ZERO(&cpuset);
-        CPU_SET(i % std::thread::hardware_concurrency(), &cpuset);
-        pthread_setaffinity_np(threads.back()->native_handle(), 
-                              sizeof(cpu_set_t), &cpuset);
-#endif
+    {
+        std::lock_guard<std::mutex> lock(scale_mutex);
+        reconcile_workers();
     }
     
-    threads.push_back(std::make_unique<std::thread>([this]() {
+    reporter.reset(new std::thread([this]() {
         auto last_update = std::chrono::steady_clock::now();
+        sample_time = last_update;
         
         while (running) {
+            sample_hashrates();
+            {
+                // Restarts a slot whose worker exited just as it was re-added
+                std::lock_guard<std::mutex> lock(scale_mutex);
+                reconcile_workers();
+            }
+            
             auto now = std::chrono::steady_clock::now();
             auto elapsed = std::chrono::duration_cast<std::chrono::seconds>(
                 now - last_update).count();
             
             if (elapsed >= 10) {
-                double total_hr = 0.0;
-                {
-                    std::lock_guard<std::mutex> lock(stats.hashrate_mutex);
-                    for (double hr : stats.thread_hashrates) {
-                        total_hr += hr;
+                Logger::speed_update(
+                    stats.total.h10s.load(std::memory_order_relaxed),
+                    stats.total.h60s.load(std::memory_order_relaxed),
+                    stats.total.h15m.load(std::memory_order_relaxed),
+                    stats.max_hashrate.load(std::memory_order_relaxed)
+                );
+                
+                if (config.start_diff == "AUTO") {
+                    int tiers[DIFF_TIER_COUNT] = {0};
+                    for (int i = 0; i < target.load(); i++) {
+                        tiers[stats.workers[i].tier.load(std::memory_order_relaxed)]++;
                     }
+                    Logger::diff_summary(tiers[DIFF_LOW], tiers[DIFF_MEDIUM], tiers[DIFF_NET]);
                 }
                 
-                Logger::speed_update(
-                    config.threads,
-                    total_hr,
-                    stats.accepted.load(),
-                    stats.rejected.load()
-                );
+                if (network.pool_count() > 1) {
+                    for (const auto& ps : get_stats().pools) {
+                        Logger::pool_update(ps.pool.ip, ps.pool.port, ps.workers,
+                                            ps.hashrate, ps.accepted, ps.rejected,
+                                            ps.rtt_ms);
+                    }
+                }
                 last_update = now;
             }
             
@@ -103,24 +323,320 @@ void Miner::start() {
     }));
 }
 
+// Starts a thread on every slot below target that has none, and marks the
+// ones above it as retiring. Caller holds scale_mutex.
+void Miner::reconcile_workers() {
+    int count = target.load();
+    bool pinned = true;
+    for (int i = 0; i < stats.worker_count; i++) {
+        WorkerStats& ws = stats.workers[i];
+        int state = ws.state.load();
+        if (i >= count) {
+            if (state == WORKER_RUNNING) ws.state.store(WORKER_RETIRING);
+            continue;
+        }
+        if (state == WORKER_RETIRING) {
+            // Still inside its loop and will see the new target
+            ws.state.store(WORKER_RUNNING);
+            continue;
+        }
+        if (state != WORKER_IDLE || !running) continue;
+        
+        // An idle slot's old thread has returned or is about to
+        if (threads[i] && threads[i]->joinable()) threads[i]->join();
+        ws.state.store(WORKER_RUNNING);
+        threads[i].reset(new std::thread(&Miner::mining_thread, this, i));
+        if (i < (int)worker_cpus.size()) {
+            pinned &= Topology::pin(threads[i]->native_handle(), {worker_cpus[i]});
+        }
+    }
+    if (!pinned) {
+        Logger::warning("Could not pin every worker to its CPU");
+    }
+}
+
+int Miner::set_workers(int count) {
+    count = std::min(std::max(count, 1), stats.worker_count);
+    std::lock_guard<std::mutex> lock(scale_mutex);
+    int old = target.load();
+    if (count == old) return count;
+    
+    target.store(count);
+    layout_pools(count);
+    scale_epoch.fetch_add(1);
+    reconcile_workers();
+    // Parked workers being retired should leave now, not on resume
+    pause_cv.notify_all();
+    Logger::info("Workers: " + std::to_string(old) + " -> " + std::to_string(count) +
+                 (count < old ? " (retiring " + std::to_string(old - count) + ")" : ""));
+    return count;
+}
+
+void Miner::sample_hashrates() {
+    auto now = std::chrono::steady_clock::now();
+    double dt = std::chrono::duration<double>(now - sample_time).count();
+    if (dt <= 0.0) return;
+    sample_time = now;
+    
+    // Until a window has filled, weight by elapsed time so the longer
+    // averages start at the real rate instead of ramping up from zero
+    double uptime = std::chrono::duration<double>(now - launch_time).count();
+    auto alpha = [&](double window) {
+        return std::max(1.0 - std::exp(-dt / window), std::min(dt / uptime, 1.0));
+    };
+    double a10 = alpha(10.0), a60 = alpha(60.0), a15m = alpha(900.0);
+    
+    auto update = [&](HashrateWindows& w, double rate) {
+        auto step = [&](std::atomic<double>& avg, double a) {
+            double v = avg.load(std::memory_order_relaxed);
+            avg.store(v + a * (rate - v), std::memory_order_relaxed);
+        };
+        step(w.h10s, a10);
+        step(w.h60s, a60);
+        step(w.h15m, a15m);
+    };
+    
+    double total_rate = 0.0;
+    double share_rate = 0.0;
+    for (int i = 0; i < stats.worker_count; i++) {
+        uint64_t hashes = stats.workers[i].hashes.load(std::memory_order_relaxed);
+        double rate = (hashes - sampled_hashes[i]) / dt;
+        sampled_hashes[i] = hashes;
+        update(stats.windows[i], rate);
+        total_rate += rate;
+        share_rate += stats.workers[i].hashrate.load(std::memory_order_relaxed);
+    }
+    update(stats.total, total_rate);
+    stats.hashrate_sum.store(share_rate, std::memory_order_relaxed);
+    
+    double h10 = stats.total.h10s.load(std::memory_order_relaxed);
+    if (h10 > stats.max_hashrate.load(std::memory_order_relaxed)) {
+        stats.max_hashrate.store(h10, std::memory_order_relaxed);
+    }
+}
+
+double Miner::total_hashrate() const {
+    return stats.hashrate_sum.load(std::memory_order_relaxed);
+}
+
+void Miner::share_counts(unsigned long& accepted, unsigned long& rejected) const {
+    accepted = rejected = 0;
+    for (size_t n = 0; n < stats.node_ids.size(); n++) {
+        accepted += stats.nodes[n].accepted.load(std::memory_order_relaxed);
+        rejected += stats.nodes[n].rejected.load(std::memory_order_relaxed);
+    }
+}
+
+MiningStatsSnapshot Miner::get_stats() const {
+    MiningStatsSnapshot snap;
+    snap.accepted = 0;
+    snap.rejected = 0;
+    snap.blocks = 0;
+    snap.total_hashrate = 0.0;
+    snap.hashes = 0;
+    snap.hashrate_10s = stats.total.h10s.load(std::memory_order_relaxed);
+    snap.hashrate_60s = stats.total.h60s.load(std::memory_order_relaxed);
+    snap.hashrate_15m = stats.total.h15m.load(std::memory_order_relaxed);
+    snap.max_hashrate = stats.max_hashrate.load(std::memory_order_relaxed);
+    snap.uptime_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - launch_time).count();
+    snap.io = SocketClient::totals.snapshot();
+    snap.workers = target.load(std::memory_order_relaxed);
+    snap.max_workers = stats.worker_count;
+    
+    uint64_t tier_bytes[DIFF_TIER_COUNT] = {};
+    uint64_t tier_accepted[DIFF_TIER_COUNT] = {};
+    snap.nodes.resize(stats.node_ids.size());
+    for (size_t n = 0; n < stats.node_ids.size(); n++) {
+        const NodeStats& ns = stats.nodes[n];
+        NodeSnapshot& node = snap.nodes[n];
+        node.node = stats.node_ids[n];
+        node.accepted = ns.accepted.load(std::memory_order_relaxed);
+        node.rejected = ns.rejected.load(std::memory_order_relaxed);
+        node.blocks = ns.blocks.load(std::memory_order_relaxed);
+        snap.accepted += node.accepted;
+        snap.rejected += node.rejected;
+        snap.blocks += node.blocks;
+        for (int t = 0; t < DIFF_TIER_COUNT; t++) {
+            tier_bytes[t] += ns.tier_bytes[t].load(std::memory_order_relaxed);
+            tier_accepted[t] += ns.tier_accepted[t].load(std::memory_order_relaxed);
+        }
+    }
+    for (int t = 0; t < DIFF_TIER_COUNT; t++) {
+        snap.bytes_per_share[t] = tier_accepted[t] > 0 ?
+            (double)tier_bytes[t] / tier_accepted[t] : 0.0;
+    }
+    
+    int pool_count = network.pool_count();
+    snap.pools.resize(pool_count);
+    for (int i = 0; i < pool_count; i++) {
+        const PoolStats& ps = network.get_pool_stats(i);
+        snap.pools[i] = {
+            network.get_pool(i),
+            ps.workers.load(),
+            0.0,
+            ps.accepted.load(),
+            ps.rejected.load(),
+            ps.blocks.load(),
+            ps.rtt_ms.load(),
+            ps.job_rtt.summary(),
+            ps.solve_time.summary(),
+            ps.submit_rtt.summary()
+        };
+    }
+    
+    for (int c = 0; c < CORE_CLASS_COUNT; c++) {
+        snap.classes[c].weight = class_weight[c];
+        snap.classes[c].difficulty = class_diff[c];
+        snap.classes[c].kernel = class_kernel_name[c];
+    }
+    
+    // Every slot up to target, plus retiring ones still finishing a job;
+    // idle slots past that only add their past traffic
+    int shown = snap.workers;
+    for (int i = shown; i < stats.worker_count; i++) {
+        if (stats.workers[i].state.load(std::memory_order_relaxed) != WORKER_IDLE) shown = i + 1;
+    }
+    snap.threads.resize(shown);
+    for (int i = 0; i < stats.worker_count; i++) {
+        const WorkerStats& ws = stats.workers[i];
+        IoSnapshot io = ws.io.snapshot();
+        snap.io.bytes_sent += io.bytes_sent;
+        snap.io.bytes_received += io.bytes_received;
+        snap.io.messages_sent += io.messages_sent;
+        snap.io.messages_received += io.messages_received;
+        snap.io.syscalls += io.syscalls;
+        snap.io.connects += io.connects;
+        snap.hashes += ws.hashes.load(std::memory_order_relaxed);
+        if (i >= shown) continue;
+        
+        const HashrateWindows& w = stats.windows[i];
+        const WorkerLatency& lat = stats.latency[i];
+        double hr = ws.hashrate.load(std::memory_order_relaxed);
+        double hr_10s = w.h10s.load(std::memory_order_relaxed);
+        snap.total_hashrate += hr;
+        int pool_index = ws.pool.load(std::memory_order_relaxed);
+        if (pool_index >= 0 && pool_index < pool_count) {
+            snap.pools[pool_index].hashrate += hr_10s;
+        }
+        snap.threads[i] = {
+            hr,
+            hr_10s,
+            w.h60s.load(std::memory_order_relaxed),
+            w.h15m.load(std::memory_order_relaxed),
+            pool_index,
+            ws.tier.load(std::memory_order_relaxed),
+            ws.solve_ms.load(std::memory_order_relaxed),
+            ws.useful_permille.load(std::memory_order_relaxed),
+            ws.hashes.load(std::memory_order_relaxed),
+            ws.jobs.load(std::memory_order_relaxed),
+            lat.job_rtt.summary(),
+            lat.solve_time.summary(),
+            lat.submit_rtt.summary(),
+            {},
+            {},
+            ws.phase.load(std::memory_order_relaxed),
+            io,
+            ws.tid.load(std::memory_order_relaxed),
+            ws.core_class.load(std::memory_order_relaxed),
+            ws.state.load(std::memory_order_relaxed)
+        };
+        bool active = snap.threads[i].state != WORKER_IDLE;
+        ClassSnapshot& cs = snap.classes[snap.threads[i].core_class];
+        cs.threads += active;
+        cs.hashrate += hr_10s;
+        NodeSnapshot& node = snap.nodes[ws.node.load(std::memory_order_relaxed)];
+        node.threads += active;
+        node.hashrate += hr_10s;
+        for (int p = 0; p < PHASE_COUNT; p++) {
+            snap.threads[i].ns_phase[p] = ws.ns_phase[p].load(std::memory_order_relaxed);
+        }
+        for (int e = 0; e < PERF_EVENT_COUNT; e++) {
+            snap.threads[i].perf[e] = ws.perf[e].load(std::memory_order_relaxed);
+        }
+    }
+    return snap;
+}
+
+const char* Miner::phase_name(int phase) {
+    static const char* names[PHASE_COUNT] = {
+        "connect", "job", "decode", "hash", "submit", "log", "throttle", "paused"
+    };
+    return phase >= 0 && phase < PHASE_COUNT ? names[phase] : "?";
+}
+
+const char* Miner::state_name(int state) {
+    static const char* names[] = {"idle", "running", "retiring"};
+    return state >= WORKER_IDLE && state <= WORKER_RETIRING ? names[state] : "?";
+}
+
 void Miner::stop() {
-    running = false;
+    {
+        std::lock_guard<std::mutex> lock(pause_mutex);
+        running = false;
+    }
+    pause_cv.notify_all();
     
+    // Waits out a reconcile_workers that saw running still set; none starts
+    // a thread after this
+    { std::lock_guard<std::mutex> lock(scale_mutex); }
     for (auto& thread : threads) {
         if (thread && thread->joinable()) {
             thread->join();
         }
     }
-    threads.clear();
+    if (reporter && reporter->joinable()) {
+        reporter->join();
+    }
+    journal.close();
 }
 
-bool Miner::get_job(SocketClient& client, std::string& last_hash, 
+void Miner::pause() {
+    paused = true;
+}
+
+void Miner::resume() {
+    {
+        std::lock_guard<std::mutex> lock(pause_mutex);
+        paused = false;
+    }
+    pause_cv.notify_all();
+}
+
+std::chrono::steady_clock::duration Miner::wait_if_paused(int thread_id) {
+    if (!paused.load(std::memory_order_relaxed)) {
+        return std::chrono::steady_clock::duration::zero();
+    }
+    
+    auto park_start = std::chrono::steady_clock::now();
+    stats.workers[thread_id].hashrate.store(0.0, std::memory_order_relaxed);
+    
+    std::unique_lock<std::mutex> lock(pause_mutex);
+    pause_cv.wait(lock, [this, thread_id] {
+        return !paused || !running || retiring(thread_id);
+    });
+    return std::chrono::steady_clock::now() - park_start;
+}
+
+bool Miner::refresh_after_pause(std::chrono::steady_clock::duration parked,
+                                int thread_id) const {
+    if (config.pause_refresh <= 0 || parked <= std::chrono::seconds(config.pause_refresh)) {
+        return false;
+    }
+    // Spread like the connect back-off, so a resume does not bring every
+    // worker back to the pool in the same instant
+    std::this_thread::sleep_for(std::chrono::milliseconds(
+        5000LL * thread_id / stats.worker_count));
+    return true;
+}
+
+bool Miner::get_job(SocketClient& client, const char* diff_tier, std::string& last_hash, 
                    std::string& expected_hash, int& difficulty) {
     static thread_local char send_buffer[256];
     int len = snprintf(send_buffer, sizeof(send_buffer), 
                       "JOB,%s,%s,%s",
                       config.username.c_str(),
-                      config.start_diff.c_str(),
+                      diff_tier,
                       config.mining_key.c_str());
     
     if (!client.send(std::string(send_buffer, len))) {
@@ -148,7 +664,9 @@ bool Miner::get_job(SocketClient& client, std::string& last_hash,
 
 bool Miner::submit_share(SocketClient& client, unsigned long result, 
                         double hashrate, int thread_id, int difficulty, 
-                        double compute_time, int ping) {
+                        uint64_t job_rtt_us, int pool_index,
+                        uint64_t solve_us, int& submit_rtt, std::string& reason,
+                        const char*& verdict) {
     static thread_local char send_buffer[512];
     // CHỈ SỬA DÒNG NÀY - Đổi "PC" thành "" để có 2 dấu phẩy liên tiếp
     int len = snprintf(send_buffer, sizeof(send_buffer),
@@ -157,15 +675,28 @@ bool Miner::submit_share(SocketClient& client, unsigned long result,
                       config.rig_identifier.c_str(),
                       config.miner_id.c_str());
     
-    if (!client.send(std::string(send_buffer, len))) {
-        return false;
-    }
+    verdict = nullptr;
+    auto submit_start = std::chrono::steady_clock::now();
+    auto elapsed_us = [&submit_start]() -> uint64_t {
+        return std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - submit_start).count();
+    };
     
-    std::string response = client.receive(10);
+    std::string response;
+    if (client.send(std::string(send_buffer, len))) {
+        response = client.receive(10);
+    }
     if (response.empty()) {
+        journal.share(thread_id, pool_index, difficulty / 100, result, solve_us, job_rtt_us,
+                      elapsed_us(), JOURNAL_LOST, "");
+        // A late verdict would be read as the next job
+        client.disconnect();
         return false;
     }
     
+    uint64_t submit_us = elapsed_us();
+    submit_rtt = submit_us / 1000;
+    
     while (!response.empty() && 
            (response.back() == '\n' || response.back() == '\r' || 
             response.back() == ' ')) {
@@ -175,51 +706,90 @@ bool Miner::submit_share(SocketClient& client, unsigned long result,
     bool is_good = (response.compare(0, 4, "GOOD") == 0);
     bool is_block = (response.compare(0, 5, "BLOCK") == 0);
     
+    stats.latency[thread_id].submit_rtt.record(submit_us);
+    network.record_share(pool_index, is_good || is_block, is_block, solve_us, submit_us);
+    
+    // BAD,<reason>
+    size_t comma = response.find(',');
+    reason = comma != std::string::npos ? response.substr(comma + 1) : "";
+    journal.share(thread_id, pool_index, difficulty / 100, result, solve_us, job_rtt_us, submit_us,
+                  is_block ? JOURNAL_BLOCK : is_good ? JOURNAL_ACCEPT : JOURNAL_REJECT, reason);
+    
+    NodeStats& node = stats.nodes[stats.workers[thread_id].node.load(std::memory_order_relaxed)];
     if (is_good || is_block) {
-        stats.accepted++;
+        node.accepted.fetch_add(1, std::memory_order_relaxed);
         if (is_block) {
-            stats.blocks++;
-        }
-        
-        double total_hr = 0.0;
-        {
-            std::lock_guard<std::mutex> lock(stats.hashrate_mutex);
-            for (double hr : stats.thread_hashrates) {
-                total_hr += hr;
-            }
+            node.blocks.fetch_add(1, std::memory_order_relaxed);
         }
-        
-        Logger::share(thread_id, is_block ? "BLOCK" : "ACCEPT", 
-                     stats.accepted.load(), stats.rejected.load(), 
-                     hashrate, total_hr, 
-                     compute_time, difficulty, ping);
+        verdict = is_block ? "BLOCK" : "ACCEPT";
         return true;
     } else {
-        stats.rejected++;
-        
-        double total_hr = 0.0;
-        {
-            std::lock_guard<std::mutex> lock(stats.hashrate_mutex);
-            for (double hr : stats.thread_hashrates) {
-                total_hr += hr;
-            }
-        }
-        
-        Logger::share(thread_id, "REJECT", stats.accepted.load(), 
-                     stats.rejected.load(), hashrate, total_hr, 
-                     compute_time, difficulty, ping);
+        node.rejected.fetch_add(1, std::memory_order_relaxed);
+        verdict = "REJECT";
         return false;
     }
 }
 
+void Miner::log_share(int thread_id, const char* verdict, double hashrate,
+                      int difficulty, double compute_time, int ping) {
+    unsigned long accepted, rejected;
+    share_counts(accepted, rejected);
+    Logger::share(thread_id, verdict, accepted, rejected,
+                  hashrate, total_hashrate(), compute_time, difficulty, ping);
+}
+
 void Miner::mining_thread(int thread_id) {
     SocketClient client;
-    PoolInfo pool = network.get_pool();
+    PoolInfo pool;
+    int pool_index = -1;
+    unsigned long jobs_done = 0;
+    WorkerStats& ws = stats.workers[thread_id];
+    NodeStats& node = stats.nodes[ws.node.load(std::memory_order_relaxed)];
+    int core_class = ws.core_class.load(std::memory_order_relaxed);
+    DifficultyController diff_ctl(class_diff[core_class]);
+    Hasher::CompareKernel compare = class_kernel[core_class];
+    client.set_counters(&ws.io);
+    ws.tid.store(syscall(SYS_gettid), std::memory_order_relaxed);
+    uint64_t bytes_mark = 0;    // ws.io traffic at the last share verdict
+    
+    unsigned epoch = scale_epoch.load();
+    Throttle throttle(config.intensity, hashrate_cap(core_class));
     static thread_local uint8_t expected_bytes[20];
     static thread_local uint8_t hash_output[20];
+    PhaseClock phases(ws, thread_id, PHASE_CONNECT);
+    
+    PerfCounters perf;
+    if (config.perf_counters) {
+        if (perf.open()) {
+            phases.set_perf(&perf);
+        } else if (thread_id == 0) {
+            Logger::warning("Hardware counters unavailable: " + PerfCounters::last_error());
+        }
+    }
     
-    while (running) {
+    while (running && !retiring(thread_id)) {
+        if (paused.load(std::memory_order_relaxed)) {
+            phases.enter(PHASE_PAUSED);
+            if (refresh_after_pause(wait_if_paused(thread_id), thread_id)) {
+                client.disconnect();
+            }
+            if (retiring(thread_id)) break;
+        }
+        
+        // The worker count changed: max_hashrate is split anew
+        if (scale_epoch.load(std::memory_order_relaxed) != epoch) {
+            epoch = scale_epoch.load();
+            if (config.max_hashrate > 0) throttle.set_max_hashrate(hashrate_cap(core_class));
+        }
+        
         if (!client.is_connected()) {
+            Trace::instant(thread_id, "reconnect", phases.enter(PHASE_CONNECT));
+            if (pool_index < 0) {
+                pool_index = network.assign_pool(pool_position[thread_id]);
+                ws.pool.store(pool_index, std::memory_order_relaxed);
+            }
+            pool = network.get_pool(pool_index);
+            
             if (thread_id == 0) {
                 Logger::net_connect(pool.ip, pool.port);
             }
@@ -230,11 +800,17 @@ void Miner::mining_thread(int thread_id) {
                 if (thread_id == 0) {
                     Logger::net_error("Connection failed");
                 }
-                std::this_thread::sleep_for(std::chrono::seconds(5));
+                // Let the balancer move this thread if another pool is healthier
+                network.release_pool(pool_index);
+                pool_index = -1;
+                // 5-10 s spread over the workers, so hundreds of them do not
+                // come back to the pool in the same instant
+                std::this_thread::sleep_for(std::chrono::milliseconds(
+                    5000 + 5000LL * thread_id / stats.worker_count));
                 continue;
             }
             
-            std::string version = client.receive(5);
+            std::string version = client.receive_banner(5);
             
             auto connect_end = std::chrono::high_resolution_clock::now();
             int connect_ping = std::chrono::duration_cast<std::chrono::milliseconds>(
@@ -243,32 +819,50 @@ void Miner::mining_thread(int thread_id) {
             if (thread_id == 0) {
                 Logger::net_connected(version, connect_ping);
             }
+            journal.pool(pool_index, pool.ip + ":" + std::to_string(pool.port));
         }
         
         std::string last_hash, expected_hash;
         int difficulty;
         
-        auto ping_start = std::chrono::high_resolution_clock::now();
+        int64_t ping_start = phases.enter(PHASE_JOB);
         
-        if (!get_job(client, last_hash, expected_hash, difficulty)) {
+        if (!get_job(client, diff_ctl.get_tier_name(), last_hash, expected_hash, difficulty)) {
             client.disconnect();
             continue;
         }
         
-        auto ping_end = std::chrono::high_resolution_clock::now();
-        int ping = std::chrono::duration_cast<std::chrono::milliseconds>(
-            ping_end - ping_start).count();
+        int64_t job_received = phases.enter(PHASE_DECODE);
+        Trace::instant(thread_id, "job received", job_received, "difficulty", difficulty);
+        uint64_t ping_ns = job_received - ping_start;
+        int ping = ping_ns / 1000000;
+        stats.latency[thread_id].job_rtt.record(ping_ns / 1000);
+        network.record_job(pool_index, ping_ns / 1000);
+        journal.job(thread_id, pool_index, difficulty / 100, ping_ns / 1000);
+        WorkerStats::add(ws.jobs, 1);
+        
+        // Plain load first: an exchange on every job would keep the line
+        // bouncing between all workers
+        if (first_job.load(std::memory_order_relaxed) && first_job.exchange(false)) {
+            auto ttfj = std::chrono::duration_cast<std::chrono::milliseconds>(
+                std::chrono::steady_clock::now() - launch_time).count();
+            Logger::info("Time to first job: " + std::to_string(ttfj) + " ms");
+        }
         
         Hasher::hex_to_bytes(expected_hash, expected_bytes);
         
         const char* last_hash_cstr = last_hash.c_str();
         size_t last_hash_len = last_hash.length();
         
+        phases.enter(PHASE_HASHING);
         auto start_time = std::chrono::high_resolution_clock::now();
         unsigned long hashes_done = 0;
         
         bool found = false;
+        bool abandoned = false;
         unsigned long difficulty_ul = (unsigned long)difficulty;
+        unsigned long last_check = 0;
+        unsigned long next_check = throttle.get_batch();
         
         for (unsigned long nonce = 0; nonce < difficulty_ul && running; nonce++) {
             if (nonce + 16 < difficulty_ul) {
@@ -286,59 +880,145 @@ void Miner::mining_thread(int thread_id) {
 // #else
 //             bool match = (memcmp(hash_output, expected_bytes, 20) == 0);
 // #endif
-            bool match = Hasher::ducos1_compare(hash_output, expected_bytes);
+            bool match = compare(hash_output, expected_bytes);
             if (match) {
                 auto end_time = std::chrono::high_resolution_clock::now();
                 auto duration = std::chrono::duration_cast<std::chrono::microseconds>(
                     end_time - start_time).count();
                 
                 double compute_time = duration / 1000000.0;
+                stats.latency[thread_id].solve_time.record(duration);
                 double hashrate = duration > 0 ? 
                     (hashes_done * 1000000.0 / duration) : 0.0;
                 
-                {
-                    std::lock_guard<std::mutex> lock(stats.hashrate_mutex);
-                    stats.thread_hashrates[thread_id] = hashrate;
-                }
+                WorkerStats::add(ws.hashes, hashes_done - last_check);
+                ws.hashrate.store(hashrate, std::memory_order_relaxed);
+                
+                Trace::instant(thread_id, "share found", phases.enter(PHASE_SUBMIT),
+                               "nonce", nonce);
+                int submit_rtt = 0;
+                std::string reason;
+                const char* verdict;
+                bool accepted = submit_share(client, nonce, hashrate, thread_id, 
+                           difficulty, ping_ns / 1000, pool_index,
+                           duration, submit_rtt, reason, verdict);
                 
-                submit_share(client, nonce, hashrate, thread_id, 
-                           difficulty, compute_time, ping);
+                int64_t verdict_time = phases.enter(PHASE_LOG);
+                // A lost verdict is neither accepted nor rejected: it stays out
+                // of the tier controller, and its traffic is counted with the
+                // next share that gets one
+                if (verdict) {
+                    Trace::instant(thread_id, verdict, verdict_time, "rtt_ms", submit_rtt);
+                    log_share(thread_id, verdict, hashrate, difficulty, compute_time, ping);
+                    
+                    int old_tier = diff_ctl.get_tier();
+                    uint64_t bytes = ws.io.bytes_sent.load(std::memory_order_relaxed) +
+                                     ws.io.bytes_received.load(std::memory_order_relaxed);
+                    node.tier_bytes[old_tier].fetch_add(bytes - bytes_mark,
+                                                        std::memory_order_relaxed);
+                    bytes_mark = bytes;
+                    if (accepted) {
+                        node.tier_accepted[old_tier].fetch_add(1, std::memory_order_relaxed);
+                    }
+                    if (diff_ctl.record(compute_time, ping, submit_rtt, accepted, reason)) {
+                        Logger::diff_change(thread_id, DifficultyController::tier_name(old_tier),
+                                            diff_ctl.get_tier_name(), diff_ctl.get_reason());
+                    }
+                    ws.tier.store(diff_ctl.get_tier(), std::memory_order_relaxed);
+                    ws.solve_ms.store(diff_ctl.get_solve_time() * 1000, std::memory_order_relaxed);
+                    ws.useful_permille.store(diff_ctl.get_useful() * 1000, std::memory_order_relaxed);
+                }
                 found = true;
                 break;
             }
             
-            if ((hashes_done & 0xFFFF) == 0) {
+            if (hashes_done >= next_check) {
+                WorkerStats::add(ws.hashes, hashes_done - last_check);
+                
+                // Paused mid-job: keep the job and nonce, and do not count
+                // the parked time against the hashrate. After a long pause
+                // the job is dropped with the connection and a fresh one
+                // fetched, instead of submitting to a session gone stale
+                if (paused.load(std::memory_order_relaxed)) {
+                    phases.enter(PHASE_PAUSED);
+                    auto parked = wait_if_paused(thread_id);
+                    start_time += parked;
+                    if (refresh_after_pause(parked, thread_id)) {
+                        abandoned = true;
+                        break;
+                    }
+                }
+                
+                // A retiring worker finishes its job unless that takes longer
+                // than retire_grace or it was parked; Duino jobs belong to
+                // the connection, so the dropped one goes back with it
+                if (retiring(thread_id) &&
+                    (paused.load(std::memory_order_relaxed) ||
+                     std::chrono::high_resolution_clock::now() - start_time >
+                         std::chrono::seconds(config.retire_grace))) {
+                    abandoned = true;
+                    break;
+                }
+                
+                if (throttle.is_active()) {
+                    phases.enter(PHASE_THROTTLE);
+                    throttle.tick(hashes_done - last_check);
+                }
+                phases.enter(PHASE_HASHING);
+                last_check = hashes_done;
+                next_check = hashes_done + throttle.get_batch();
+                
                 auto current_time = std::chrono::high_resolution_clock::now();
                 auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(
                     current_time - start_time).count();
                 
                 if (elapsed > 0) {
                     double current_hashrate = hashes_done * 1000000.0 / elapsed;
-                    std::lock_guard<std::mutex> lock(stats.hashrate_mutex);
-                    stats.thread_hashrates[thread_id] = current_hashrate;
-                }
-                
-                if (config.intensity < 100) {
-                    std::this_thread::sleep_for(
-                        std::chrono::microseconds((100 - config.intensity) * 10));
+                    ws.hashrate.store(current_hashrate, std::memory_order_relaxed);
                 }
             }
         }
         
-        if (!found && running) {
+        if (!found && (running || abandoned)) {
             auto end_time = std::chrono::high_resolution_clock::now();
             auto duration = std::chrono::duration_cast<std::chrono::microseconds>(
                 end_time - start_time).count();
             
+            WorkerStats::add(ws.hashes, hashes_done - last_check);
             if (duration > 0) {
                 double final_hashrate = hashes_done * 1000000.0 / duration;
-                std::lock_guard<std::mutex> lock(stats.hashrate_mutex);
-                stats.thread_hashrates[thread_id] = final_hashrate;
+                ws.hashrate.store(final_hashrate, std::memory_order_relaxed);
             }
             
             client.disconnect();
         }
+        
+        // Adaptive sharding: periodically re-evaluate which pool this thread uses
+        jobs_done++;
+        if (network.is_adaptive() && (jobs_done & 31) == 0) {
+            network.release_pool(pool_index);
+            int next = network.assign_pool(pool_position[thread_id]);
+            if (next != pool_index) {
+                pool_index = next;
+                ws.pool.store(pool_index, std::memory_order_relaxed);
+                client.disconnect();
+            }
+        }
     }
     
+    if (pool_index >= 0) {
+        network.release_pool(pool_index);
+    }
     client.disconnect();
+    ws.hashrate.store(0.0, std::memory_order_relaxed);
+    
+    // Under scale_mutex, so reconcile_workers never sees a slot go idle
+    // between deciding to restart it and doing so
+    std::lock_guard<std::mutex> lock(scale_mutex);
+    bool retired = running && ws.state.load() == WORKER_RETIRING;
+    ws.state.store(WORKER_IDLE);
+    if (retired) {
+        Logger::info("Worker " + std::to_string(thread_id) + " retired after " +
+                     std::to_string(jobs_done) + " jobs");
+    }
 }
\ No newline at end of file
@@ -13,12 +13,51 @@
 #include <poll.h>
 #include <fcntl.h>
 #include <errno.h>
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include <ctime>
+#include <chrono>
+#include <cstdio>
+#include <mutex>
+#include <condition_variable>
+
+#define RX_FRAGMENT_MS 50
+#define REFRESH_WAIT_MS 2000    // shutdown wait for a background getPool
+
+// The refresh thread applies its answer under mutex unless shutdown has
+// given up on it, so it never touches a destroyed NetworkManager
+struct NetworkManager::RefreshState {
+    std::mutex mutex;
+    std::condition_variable cv;
+    bool done = false;
+    bool abandoned = false;
+};
+
+NetworkManager::NetworkManager() : stats(new PoolStats[MAX_POOLS]) {}
+
+NetworkManager::~NetworkManager() {
+    if (!refresh) return;
+    // A slow pool picker would hold shutdown for the whole HTTP timeout
+    std::unique_lock<std::mutex> lock(refresh->mutex);
+    if (!refresh->cv.wait_for(lock, std::chrono::milliseconds(REFRESH_WAIT_MS),
+                              [this] { return refresh->done; })) {
+        refresh->abandoned = true;
+    }
+}
 
 bool NetworkManager::initialize() {
     return true;
 }
 
-bool NetworkManager::fetch_pool() {
+bool NetworkManager::parse_pool(const std::string& response, PoolInfo& pool) {
+    pool.ip = Json::get_value(response, "ip");
+    pool.port = Json::get_int(response, "port");
+    pool.name = Json::get_value(response, "name");
+    return !pool.ip.empty() && pool.port != 0;
+}
+
+bool NetworkManager::request_pool(PoolInfo& pool) {
     std::string response = HttpClient::get("https://server.duinocoin.com/getPool");
     
     if (response.empty()) {
@@ -31,23 +70,218 @@ bool NetworkManager::fetch_pool() {
         return false;
     }
     
-    current_pool.ip = Json::get_value(response, "ip");
-    current_pool.port = Json::get_int(response, "port");
-    current_pool.name = Json::get_value(response, "name");
-    
-    if (current_pool.ip.empty() || current_pool.port == 0) {
+    if (!parse_pool(response, pool)) {
         Logger::error("Invalid pool data received");
         return false;
     }
+    return true;
+}
+
+bool NetworkManager::fetch_pool() {
+    PoolInfo pool;
+    if (!request_pool(pool)) return false;
+    use_pool(pool);
+    return true;
+}
+
+void NetworkManager::use_pool(const PoolInfo& pool) {
+    Logger::info("Selected pool: " + pool.name + " (" + 
+                 pool.ip + ":" + std::to_string(pool.port) + ")");
+    
+    set_pools({pool}, balance);
+    
+    if (cache_file.empty()) return;
+    
+    // Written aside and renamed over the cache, so a kill mid-write never
+    // leaves a truncated cache behind for the next start
+    std::string tmp = cache_file + ".tmp";
+    std::ofstream out(tmp, std::ios::trunc);
+    out << "{\"ip\":\"" << pool.ip << "\",\"port\":" << pool.port
+        << ",\"name\":\"" << pool.name << "\",\"timestamp\":"
+        << (long)time(nullptr) << "}\n";
+    out.flush();
+    out.close();
+    if (!out || rename(tmp.c_str(), cache_file.c_str()) != 0) {
+        unlink(tmp.c_str());
+        Logger::warning("Could not write pool cache " + cache_file);
+    }
+}
+
+void NetworkManager::set_cache(const std::string& file, int ttl_seconds) {
+    cache_file = file;
+    cache_ttl = ttl_seconds;
+}
+
+bool NetworkManager::load_cached_pool(bool allow_stale) {
+    if (cache_file.empty()) return false;
+    
+    std::ifstream in(cache_file);
+    if (!in) return false;
+    
+    std::stringstream ss;
+    ss << in.rdbuf();
+    std::string cached = ss.str();
+    
+    PoolInfo pool;
+    if (!parse_pool(cached, pool)) return false;
     
-    Logger::info("Selected pool: " + current_pool.name + " (" + 
-                 current_pool.ip + ":" + std::to_string(current_pool.port) + ")");
+    long age = (long)time(nullptr) - Json::get_int(cached, "timestamp");
+    if (!allow_stale && (age < 0 || age > cache_ttl)) return false;
     
+    Logger::info("Cached pool: " + pool.name + " (" + pool.ip + ":" + 
+                 std::to_string(pool.port) + ", " + std::to_string(age) + "s old)");
+    
+    set_pools({pool}, balance);
     return true;
 }
 
+void NetworkManager::refresh_pool_async() {
+    if (refresh) return;
+    
+    // Workers keep mining on the cached pool; a changed answer is picked up
+    // on their next reconnect.
+    refresh = std::make_shared<RefreshState>();
+    std::thread([this, state = refresh]() {
+        PoolInfo pool;
+        bool fetched = request_pool(pool);
+        std::lock_guard<std::mutex> lock(state->mutex);
+        if (!state->abandoned) {
+            if (fetched) {
+                use_pool(pool);
+            } else {
+                Logger::warning("Pool refresh failed, keeping cached pool");
+            }
+        }
+        state->done = true;
+        state->cv.notify_all();
+    }).detach();
+}
+
+void NetworkManager::set_pools(const std::vector<PoolInfo>& list, const std::string& mode) {
+    std::lock_guard<std::mutex> lock(pool_mutex);
+    pools.assign(list.begin(), list.begin() + std::min<size_t>(list.size(), MAX_POOLS));
+    balance = mode;
+}
+
+PoolInfo NetworkManager::get_pool(int index) const {
+    std::lock_guard<std::mutex> lock(pool_mutex);
+    if (index < 0 || index >= (int)pools.size()) {
+        return PoolInfo{"", 0, "", 1};
+    }
+    return pools[index];
+}
+
+int NetworkManager::pool_count() const {
+    std::lock_guard<std::mutex> lock(pool_mutex);
+    return pools.size();
+}
+
+int NetworkManager::assign_pool(double position) {
+    int index = 0;
+    {
+        std::lock_guard<std::mutex> lock(pool_mutex);
+        if (pools.size() > 1) {
+            if (balance == "adaptive") {
+                index = pick_adaptive();
+            } else {
+                // Contiguous groups of threads, sized proportionally to weight
+                int total_weight = 0;
+                for (const auto& p : pools) total_weight += std::max(p.weight, 0);
+                if (total_weight > 0) {
+                    double pos = position * total_weight;
+                    int acc = 0;
+                    for (size_t i = 0; i < pools.size(); i++) {
+                        acc += std::max(pools[i].weight, 0);
+                        if (pos < acc) {
+                            index = i;
+                            break;
+                        }
+                    }
+                }
+            }
+        }
+    }
+    stats[index].workers++;
+    return index;
+}
+
+int NetworkManager::pick_adaptive() const {
+    // Target share of workers per pool is proportional to
+    // weight * accept_rate / rtt; pick the pool furthest below its target.
+    double scores[MAX_POOLS];
+    double score_sum = 0.0;
+    int workers_sum = 0;
+    
+    for (size_t i = 0; i < pools.size(); i++) {
+        unsigned long acc = stats[i].accepted.load(std::memory_order_relaxed);
+        unsigned long rej = stats[i].rejected.load(std::memory_order_relaxed);
+        double accept_rate = (acc + 1.0) / (acc + rej + 2.0);
+        double rtt = stats[i].rtt_ms.load(std::memory_order_relaxed) + 10.0;
+        scores[i] = std::max(pools[i].weight, 0) * accept_rate / rtt;
+        score_sum += scores[i];
+        workers_sum += stats[i].workers.load(std::memory_order_relaxed);
+    }
+    
+    if (score_sum <= 0.0) return 0;
+    
+    int best = 0;
+    double best_deficit = -1e300;
+    for (size_t i = 0; i < pools.size(); i++) {
+        double target = scores[i] / score_sum * (workers_sum + 1);
+        double deficit = target - stats[i].workers.load(std::memory_order_relaxed);
+        if (deficit > best_deficit) {
+            best_deficit = deficit;
+            best = i;
+        }
+    }
+    return best;
+}
+
+void NetworkManager::release_pool(int index) {
+    if (index >= 0 && index < MAX_POOLS) {
+        stats[index].workers--;
+    }
+}
+
+void NetworkManager::record_job(int index, uint64_t rtt_us) {
+    if (index < 0 || index >= MAX_POOLS) return;
+    stats[index].job_rtt.record(rtt_us);
+}
+
+void NetworkManager::record_share(int index, bool accepted, bool block, uint64_t solve_us,
+                                  uint64_t rtt_us) {
+    if (index < 0 || index >= MAX_POOLS) return;
+    PoolStats& ps = stats[index];
+    ps.solve_time.record(solve_us);
+    ps.submit_rtt.record(rtt_us);
+    
+    if (accepted) {
+        ps.accepted.fetch_add(1, std::memory_order_relaxed);
+        if (block) ps.blocks.fetch_add(1, std::memory_order_relaxed);
+    } else {
+        ps.rejected.fetch_add(1, std::memory_order_relaxed);
+    }
+    
+    // EWMA with alpha = 1/8; racy updates only lose a sample
+    int rtt_ms = rtt_us / 1000;
+    int old_rtt = ps.rtt_ms.load(std::memory_order_relaxed);
+    int new_rtt = old_rtt == 0 ? rtt_ms : old_rtt + (rtt_ms - old_rtt) / 8;
+    ps.rtt_ms.store(new_rtt, std::memory_order_relaxed);
+}
+
+IoCounters SocketClient::totals;
+
 SocketClient::SocketClient() : sockfd(-1), connected(false) {}
 
+void SocketClient::account(std::atomic<uint64_t> IoCounters::*field, uint64_t n) {
+    if (counters) {
+        std::atomic<uint64_t>& own = counters->*field;
+        own.store(own.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+        return;
+    }
+    (totals.*field).fetch_add(n, std::memory_order_relaxed);
+}
+
 SocketClient::~SocketClient() {
     disconnect();
 }
@@ -66,9 +300,13 @@ bool SocketClient::connect(const std::string& host, int port, int timeout) {
         return false;
     }
     
+    // socket, 2 fcntl, 10 setsockopt and connect per attempt
+    uint64_t calls = 0;
     for (p = servinfo; p != nullptr; p = p->ai_next) {
+        calls++;
         sockfd = socket(p->ai_family, p->ai_socktype | SOCK_CLOEXEC, p->ai_protocol);
         if (sockfd == -1) continue;
+        calls += 13;
         
         int flags = fcntl(sockfd, F_GETFL, 0);
         fcntl(sockfd, F_SETFL, flags | O_NONBLOCK);
@@ -108,13 +346,16 @@ bool SocketClient::connect(const std::string& host, int port, int timeout) {
                 pfd.events = POLLOUT;
                 
                 int ret = poll(&pfd, 1, timeout * 1000);
+                calls++;
                 if (ret > 0) {
                     int error = 0;
                     socklen_t len = sizeof(error);
                     getsockopt(sockfd, SOL_SOCKET, SO_ERROR, &error, &len);
+                    calls++;
                     
                     if (error == 0) {
                         fcntl(sockfd, F_SETFL, flags);
+                        calls++;
                         connected = true;
                         break;
                     }
@@ -122,28 +363,43 @@ bool SocketClient::connect(const std::string& host, int port, int timeout) {
             }
             
             close(sockfd);
+            calls++;
             sockfd = -1;
             continue;
         }
         
         fcntl(sockfd, F_SETFL, flags);
+        calls++;
         connected = true;
         break;
     }
     
     freeaddrinfo(servinfo);
+    account(&IoCounters::syscalls, calls);
+    if (connected) {
+        account(&IoCounters::connects, 1);
+    }
     return connected;
 }
 
 bool SocketClient::send(const std::string& data) {
+    std::string msg = data + "\n";
+    if (!send_raw(msg.c_str(), msg.length())) return false;
+    account(&IoCounters::messages_sent, 1);
+    return true;
+}
+
+bool SocketClient::send_raw(const char* data, size_t len) {
     if (!connected) return false;
     
-    std::string msg = data + "\n";
     size_t total_sent = 0;
-    size_t remaining = msg.length();
+    size_t remaining = len;
+    uint64_t calls = 0;
+    bool ok = true;
     
-    while (total_sent < msg.length()) {
-        ssize_t sent = ::send(sockfd, msg.c_str() + total_sent, remaining, MSG_NOSIGNAL);
+    while (total_sent < len) {
+        ssize_t sent = ::send(sockfd, data + total_sent, remaining, MSG_NOSIGNAL);
+        calls++;
         
         if (sent == -1) {
             if (errno == EAGAIN || errno == EWOULDBLOCK) {
@@ -151,54 +407,129 @@ bool SocketClient::send(const std::string& data) {
                 pfd.fd = sockfd;
                 pfd.events = POLLOUT;
                 
+                calls++;
                 if (poll(&pfd, 1, 5000) <= 0) {
-                    return false;
+                    ok = false;
+                    break;
                 }
                 continue;
             }
-            return false;
+            ok = false;
+            break;
         }
         
         total_sent += sent;
         remaining -= sent;
     }
     
-    return true;
+    account(&IoCounters::syscalls, calls);
+    account(&IoCounters::bytes_sent, total_sent);
+    return ok;
 }
 
 std::string SocketClient::receive(int timeout) {
+    return read_message(timeout, false);
+}
+
+std::string SocketClient::receive_banner(int timeout) {
+    return read_message(timeout, true);
+}
+
+std::string SocketClient::read_message(int timeout, bool banner) {
     if (!connected) return "";
     
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(timeout);
+    uint64_t calls = 0;
+    uint64_t bytes = 0;
+    // Counted once per call, on every exit path
+    auto finish = [&](std::string line) {
+        account(&IoCounters::syscalls, calls);
+        account(&IoCounters::bytes_received, bytes);
+        if (!line.empty()) account(&IoCounters::messages_received, 1);
+        return line;
+    };
+    
+    while (true) {
+        size_t newline = rx_buffer.find('\n');
+        if (newline != std::string::npos) {
+            std::string line = rx_buffer.substr(0, newline);
+            rx_buffer.erase(0, newline + 1);
+            return finish(std::move(line));
+        }
+        
+        int wait_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+            deadline - std::chrono::steady_clock::now()).count();
+        // The version banner has no trailing newline and ends once the
+        // peer goes quiet for a moment. Every other message waits for its
+        // newline: a slow link must not split a JOB or verdict line.
+        if (banner && !rx_buffer.empty()) {
+            wait_ms = std::min(wait_ms, RX_FRAGMENT_MS);
+        }
+        
+        struct pollfd pfd;
+        pfd.fd = sockfd;
+        pfd.events = POLLIN;
+        
+        if (wait_ms > 0) calls++;
+        if (wait_ms <= 0 || poll(&pfd, 1, wait_ms) <= 0) {
+            if (!banner) {
+                // Timed out mid-line: the caller drops the session, and
+                // disconnect() discards the partial line with it
+                return finish("");
+            }
+            std::string partial;
+            partial.swap(rx_buffer);
+            return finish(std::move(partial));
+        }
+        
+        char buffer[4096];
+        ssize_t n = recv(sockfd, buffer, sizeof(buffer), MSG_DONTWAIT);
+        calls++;
+        
+        if (n <= 0) {
+            if (n == -1 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+                continue;
+            }
+            connected = false;
+            rx_buffer.clear();
+            return finish("");
+        }
+        
+        rx_buffer.append(buffer, n);
+        bytes += n;
+        
+        int flag = 1;
+        setsockopt(sockfd, IPPROTO_TCP, TCP_QUICKACK, &flag, sizeof(flag));
+        calls++;
+    }
+}
+
+ssize_t SocketClient::receive_raw(char* buffer, size_t len, int timeout) {
+    if (!connected) return -1;
+    
     struct pollfd pfd;
     pfd.fd = sockfd;
     pfd.events = POLLIN;
     
     int ret = poll(&pfd, 1, timeout * 1000);
-    if (ret <= 0) return "";
-    
-    char buffer[4096];
-    ssize_t n = recv(sockfd, buffer, sizeof(buffer) - 1, MSG_DONTWAIT);
+    if (ret <= 0) {
+        account(&IoCounters::syscalls, 1);
+        return -1;
+    }
     
+    ssize_t n = recv(sockfd, buffer, len, MSG_DONTWAIT);
+    account(&IoCounters::syscalls, 2);
+    if (n > 0) {
+        account(&IoCounters::bytes_received, n);
+    }
     if (n <= 0) {
         if (n == -1 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
-            return "";
+            return -1;
         }
         connected = false;
-        return "";
-    }
-    
-    buffer[n] = '\0';
-    std::string result(buffer);
-    
-    size_t newline = result.find('\n');
-    if (newline != std::string::npos) {
-        result = result.substr(0, newline);
+        return n == 0 ? 0 : -1;
     }
-    
-    int flag = 1;
-    setsockopt(sockfd, IPPROTO_TCP, TCP_QUICKACK, &flag, sizeof(flag));
-    
-    return result;
+    return n;
 }
 
 void SocketClient::disconnect() {
@@ -208,4 +539,5 @@ void SocketClient::disconnect() {
         sockfd = -1;
     }
     connected = false;
+    rx_buffer.clear();
 }
\ No newline at end of file
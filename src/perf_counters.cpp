@@ -0,0 +1,130 @@
+#include "../include/perf_counters.h"
+#include <cstring>
+#include <cerrno>
+#include <fstream>
+#include <mutex>
+#include <unistd.h>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#endif
+
+static std::mutex error_mutex;
+static std::string error_text;
+
+static void set_error(const std::string& text) {
+    std::lock_guard<std::mutex> lock(error_mutex);
+    error_text = text;
+}
+
+PerfCounters::PerfCounters() {
+    for (int i = 0; i < PERF_EVENT_COUNT; i++) {
+        fds[i] = -1;
+        order[i] = -1;
+    }
+}
+
+PerfCounters::~PerfCounters() {
+    for (int i = 0; i < PERF_EVENT_COUNT; i++) {
+        if (fds[i] >= 0) close(fds[i]);
+    }
+}
+
+const char* PerfCounters::event_name(int event) {
+    switch (event) {
+        case PERF_CYCLES: return "cycles";
+        case PERF_INSTRUCTIONS: return "instructions";
+        case PERF_BRANCH_MISSES: return "branch-misses";
+        case PERF_L1D_MISSES: return "L1d-misses";
+        default: return "?";
+    }
+}
+
+std::string PerfCounters::last_error() {
+    std::lock_guard<std::mutex> lock(error_mutex);
+    return error_text;
+}
+
+#ifdef __linux__
+
+bool PerfCounters::open() {
+    if (is_open()) return true;
+
+    static const struct { uint32_t type; uint64_t config; } events[PERF_EVENT_COUNT] = {
+        {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES},
+        {PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS},
+        {PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES},
+        {PERF_TYPE_HW_CACHE, PERF_COUNT_HW_CACHE_L1D |
+                             (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+                             (PERF_COUNT_HW_CACHE_RESULT_MISS << 16)},
+    };
+
+    int first_errno = 0;
+    for (int i = 0; i < PERF_EVENT_COUNT; i++) {
+        struct perf_event_attr attr;
+        memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        attr.type = events[i].type;
+        attr.config = events[i].config;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED |
+                           PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+        int fd = syscall(SYS_perf_event_open, &attr, 0, -1, group_fd, 0);
+        if (fd < 0) {
+            if (!first_errno) first_errno = errno;
+            continue;
+        }
+        fds[i] = fd;
+        order[opened++] = i;
+        if (group_fd < 0) group_fd = fd;
+    }
+
+    if (group_fd >= 0) return true;
+
+    std::string reason = strerror(first_errno);
+    if (first_errno == EACCES || first_errno == EPERM) {
+        std::ifstream paranoid("/proc/sys/kernel/perf_event_paranoid");
+        int level = 0;
+        if (paranoid >> level) {
+            reason += " (perf_event_paranoid=" + std::to_string(level) + ")";
+        }
+    } else if (first_errno == ENOENT || first_errno == EOPNOTSUPP || first_errno == ENOSYS) {
+        reason = "no hardware counters available (VM or container)";
+    }
+    set_error(reason);
+    return false;
+}
+
+bool PerfCounters::read(PerfSample& sample) const {
+    if (!is_open()) return false;
+
+    // nr, time_enabled, time_running, values[nr]
+    uint64_t buf[3 + PERF_EVENT_COUNT];
+    ssize_t n = ::read(group_fd, buf, sizeof(buf));
+    if (n < (ssize_t)(3 * sizeof(uint64_t)) || buf[0] != (uint64_t)opened) {
+        return false;
+    }
+
+    double scale = buf[2] > 0 && buf[2] < buf[1] ? (double)buf[1] / buf[2] : 1.0;
+    memset(&sample, 0, sizeof(sample));
+    for (int i = 0; i < opened; i++) {
+        sample.value[order[i]] = (uint64_t)(buf[3 + i] * scale);
+    }
+    return true;
+}
+
+#else
+
+bool PerfCounters::open() {
+    set_error("perf_event_open is Linux only");
+    return false;
+}
+
+bool PerfCounters::read(PerfSample&) const {
+    return false;
+}
+
+#endif
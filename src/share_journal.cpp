@@ -0,0 +1,257 @@
+#include "../include/share_journal.h"
+#include "../include/logger.h"
+#include <cstring>
+#include <cerrno>
+#include <chrono>
+#include <algorithm>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <time.h>
+
+#define JOURNAL_BUFFER_BYTES (64 * 1024)
+#define JOURNAL_WAKE_MS 100
+
+static uint64_t wall_us() {
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    return (uint64_t)ts.tv_sec * 1000000ULL + ts.tv_nsec / 1000;
+}
+
+static void set_text(JournalRecord& record, const std::string& text) {
+    size_t len = std::min(text.length(), sizeof(record.text) - 1);
+    memcpy(record.text, text.data(), len);
+}
+
+ShareJournal::~ShareJournal() {
+    close();
+}
+
+bool ShareJournal::open(const std::string& file, uint64_t max, int keep_files,
+                        int fsync_seconds) {
+    path = file;
+    max_bytes = std::max<uint64_t>(max, sizeof(JournalFileHeader) + sizeof(JournalRecord));
+    keep = std::max(keep_files, 1);
+    fsync_interval = std::max(fsync_seconds, 1);
+    buffer.reserve(JOURNAL_BUFFER_BYTES);
+    queue.reset(new MpscQueue<JournalRecord>(JOURNAL_QUEUE_SIZE));
+
+    if (!open_file()) return false;
+
+    running = true;
+    active.store(true, std::memory_order_release);
+    writer_thread = std::thread(&ShareJournal::run, this);
+    Logger::info("Share journal: " + path);
+    return true;
+}
+
+void ShareJournal::close() {
+    active.store(false);
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        running = false;
+    }
+    cv.notify_all();
+    if (writer_thread.joinable()) {
+        writer_thread.join();
+    }
+    close_file();
+}
+
+// Appends to an existing journal when its header matches; a torn record
+// left by a crash is cut off so the file stays aligned
+bool ShareJournal::open_file() {
+    fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        Logger::error("Share journal: open " + path + ": " + strerror(errno));
+        return false;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        Logger::error("Share journal: stat " + path + ": " + strerror(errno));
+        close_file();
+        return false;
+    }
+    file_size = st.st_size;
+
+    if (file_size > 0) {
+        JournalFileHeader header;
+        bool valid = pread(fd, &header, sizeof(header), 0) == (ssize_t)sizeof(header) &&
+                     memcmp(header.magic, JOURNAL_MAGIC, sizeof(header.magic)) == 0 &&
+                     header.version == JOURNAL_VERSION &&
+                     header.record_size == sizeof(JournalRecord);
+        if (!valid) {
+            Logger::warning("Share journal: " + path + " has another format, rotating it");
+            rotate();
+            return fd >= 0;
+        }
+        uint64_t tail = (file_size - sizeof(JournalFileHeader)) % sizeof(JournalRecord);
+        if (tail != 0 && ftruncate(fd, file_size - tail) == 0) {
+            file_size -= tail;
+        }
+        return true;
+    }
+
+    JournalFileHeader header = {};
+    memcpy(header.magic, JOURNAL_MAGIC, sizeof(header.magic));
+    header.version = JOURNAL_VERSION;
+    header.record_size = sizeof(JournalRecord);
+    buffer.insert(buffer.end(), (const char*)&header, (const char*)&header + sizeof(header));
+    file_size = sizeof(header);
+
+    // A new file names its pools again so it can be read on its own
+    for (size_t i = 0; i < pools.size(); i++) {
+        if (pools[i].empty()) continue;
+        JournalRecord record = {};
+        record.time_us = wall_us();
+        record.type = JOURNAL_POOL;
+        record.pool = i;
+        set_text(record, pools[i]);
+        buffer.insert(buffer.end(), (const char*)&record, (const char*)&record + sizeof(record));
+        file_size += sizeof(record);
+    }
+    return true;
+}
+
+void ShareJournal::close_file() {
+    if (fd < 0) return;
+    flush();
+    fsync(fd);
+    ::close(fd);
+    fd = -1;
+}
+
+// file.(keep-1) -> file.keep, ..., file -> file.1
+void ShareJournal::rotate() {
+    close_file();
+    for (int i = keep - 1; i >= 1; i--) {
+        std::string from = path + "." + std::to_string(i);
+        std::string to = path + "." + std::to_string(i + 1);
+        rename(from.c_str(), to.c_str());
+    }
+    rename(path.c_str(), (path + ".1").c_str());
+    open_file();
+}
+
+void ShareJournal::append(const JournalRecord& record) {
+    if (record.type == JOURNAL_POOL) {
+        // Every worker announces its pool on connect; keep changes only
+        std::string address(record.text, strnlen(record.text, sizeof(record.text)));
+        if (record.pool >= pools.size()) pools.resize(record.pool + 1);
+        if (pools[record.pool] == address) return;
+        pools[record.pool] = address;
+    }
+    if (file_size + sizeof(record) > max_bytes) {
+        rotate();
+        if (fd < 0) return;
+        // The record that triggered the rotation is already in the new
+        // file's pool table
+        if (record.type == JOURNAL_POOL) return;
+    }
+    buffer.insert(buffer.end(), (const char*)&record, (const char*)&record + sizeof(record));
+    file_size += sizeof(record);
+    if (buffer.size() >= JOURNAL_BUFFER_BYTES) {
+        flush();
+    }
+}
+
+bool ShareJournal::flush() {
+    size_t written = 0;
+    while (written < buffer.size()) {
+        ssize_t n = write(fd, buffer.data() + written, buffer.size() - written);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            Logger::error("Share journal: write " + path + ": " + strerror(errno));
+            break;
+        }
+        written += n;
+    }
+    buffer.clear();
+    return written > 0;
+}
+
+void ShareJournal::run() {
+    auto last_sync = std::chrono::steady_clock::now();
+    bool dirty = false;
+    std::unique_lock<std::mutex> lock(mutex);
+
+    while (true) {
+        bool stopping = !running;
+        lock.unlock();
+
+        JournalRecord record;
+        while (fd >= 0 && queue->try_pop(record)) {
+            append(record);
+        }
+        if (fd >= 0 && !buffer.empty()) {
+            dirty |= flush();
+        }
+
+        unsigned long long lost = dropped.load(std::memory_order_relaxed);
+        if (lost != reported_drops) {
+            Logger::warning("Share journal: queue full, dropped " +
+                            std::to_string(lost - reported_drops) + " records");
+            reported_drops = lost;
+        }
+
+        auto now = std::chrono::steady_clock::now();
+        if (fd >= 0 && dirty && now - last_sync >= std::chrono::seconds(fsync_interval)) {
+            fsync(fd);
+            dirty = false;
+            last_sync = now;
+        }
+
+        lock.lock();
+        if (stopping) break;
+        cv.wait_for(lock, std::chrono::milliseconds(JOURNAL_WAKE_MS), [this] { return !running; });
+    }
+}
+
+void ShareJournal::record(JournalRecord record) {
+    if (!active.load(std::memory_order_acquire)) return;
+    if (!queue->try_push(std::move(record))) {
+        dropped.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+void ShareJournal::pool(int index, const std::string& address) {
+    if (!is_open()) return;
+    JournalRecord record = {};
+    record.time_us = wall_us();
+    record.type = JOURNAL_POOL;
+    record.pool = index;
+    set_text(record, address);
+    this->record(record);
+}
+
+void ShareJournal::job(int thread, int pool, int difficulty, uint32_t job_rtt_us) {
+    if (!is_open()) return;
+    JournalRecord record = {};
+    record.time_us = wall_us();
+    record.type = JOURNAL_JOB;
+    record.thread = thread;
+    record.pool = pool;
+    record.difficulty = difficulty;
+    record.job_rtt_us = job_rtt_us;
+    this->record(record);
+}
+
+void ShareJournal::share(int thread, int pool, int difficulty, uint32_t nonce,
+                         uint32_t solve_us, uint32_t job_rtt_us, uint32_t submit_rtt_us,
+                         JournalVerdict verdict, const std::string& reason) {
+    if (!is_open()) return;
+    JournalRecord record = {};
+    record.time_us = wall_us();
+    record.type = JOURNAL_SHARE;
+    record.verdict = verdict;
+    record.thread = thread;
+    record.pool = pool;
+    record.difficulty = difficulty;
+    record.nonce = nonce;
+    record.solve_us = solve_us;
+    record.job_rtt_us = job_rtt_us;
+    record.submit_rtt_us = submit_rtt_us;
+    set_text(record, reason);
+    this->record(record);
+}
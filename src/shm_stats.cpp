@@ -0,0 +1,142 @@
+#include "../include/shm_stats.h"
+#include "../include/miner.h"
+#include "../include/hasher.h"
+#include "../include/logger.h"
+#include <cstring>
+#include <algorithm>
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <time.h>
+
+ShmStatsPublisher::ShmStatsPublisher(const Miner& miner) : miner(miner) {}
+
+ShmStatsPublisher::~ShmStatsPublisher() {
+    stop();
+}
+
+bool ShmStatsPublisher::start(const std::string& shm_name, int threads, int interval,
+                              const std::string& rig) {
+    name = shm_name[0] == '/' ? shm_name : "/" + shm_name;
+    interval_ms = std::max(interval, 10);
+    thread_count = threads;
+    size = sizeof(ShmStatsHeader) + sizeof(ShmThreadStats) * threads;
+
+    int fd = shm_open(name.c_str(), O_CREAT | O_RDWR | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        Logger::error("Shared memory: shm_open " + name + ": " + strerror(errno));
+        return false;
+    }
+    if (ftruncate(fd, size) != 0) {
+        Logger::error("Shared memory: ftruncate " + name + ": " + strerror(errno));
+        close(fd);
+        shm_unlink(name.c_str());
+        return false;
+    }
+    base = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (base == MAP_FAILED) {
+        base = nullptr;
+        Logger::error("Shared memory: mmap " + name + ": " + strerror(errno));
+        shm_unlink(name.c_str());
+        return false;
+    }
+
+    memset(base, 0, size);
+    ShmStatsHeader* header = (ShmStatsHeader*)base;
+    header->header_size = sizeof(ShmStatsHeader);
+    header->thread_stride = sizeof(ShmThreadStats);
+    header->thread_count = threads;
+    header->pid = getpid();
+    header->version = SHM_STATS_VERSION;
+    strncpy(header->version_string, VERSION, sizeof(header->version_string) - 1);
+    strncpy(header->rig, rig.c_str(), sizeof(header->rig) - 1);
+    strncpy(header->kernel, Hasher::kernel_name(), sizeof(header->kernel) - 1);
+    // Magic last: readers ignore the segment until it is fully initialized
+    std::atomic_thread_fence(std::memory_order_release);
+    header->magic = SHM_STATS_MAGIC;
+
+    publish();
+    running = true;
+    publisher_thread = std::thread(&ShmStatsPublisher::run, this);
+    Logger::info("Stats published in shared memory " + name);
+    return true;
+}
+
+void ShmStatsPublisher::stop() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        running = false;
+    }
+    cv.notify_all();
+    if (publisher_thread.joinable()) {
+        publisher_thread.join();
+    }
+    if (base) {
+        munmap(base, size);
+        shm_unlink(name.c_str());
+        base = nullptr;
+    }
+}
+
+void ShmStatsPublisher::run() {
+    std::unique_lock<std::mutex> lock(mutex);
+    while (running) {
+        if (cv.wait_for(lock, std::chrono::milliseconds(interval_ms),
+                        [this] { return !running; })) {
+            break;
+        }
+        lock.unlock();
+        publish();
+        lock.lock();
+    }
+}
+
+void ShmStatsPublisher::publish() {
+    // Build the snapshot first so the write window stays short
+    MiningStatsSnapshot stats = miner.get_stats();
+    struct timespec now;
+    clock_gettime(CLOCK_REALTIME, &now);
+
+    ShmStatsHeader* header = (ShmStatsHeader*)base;
+    ShmThreadStats* threads = (ShmThreadStats*)((char*)base + sizeof(ShmStatsHeader));
+
+    uint64_t seq = header->seq.load(std::memory_order_relaxed);
+    header->seq.store(seq + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    header->update_unix_ns = (uint64_t)now.tv_sec * 1000000000ULL + now.tv_nsec;
+    header->uptime_ns = stats.uptime_ns;
+    header->accepted = stats.accepted;
+    header->rejected = stats.rejected;
+    header->blocks = stats.blocks;
+    header->hashrate_10s = stats.hashrate_10s;
+    header->hashrate_60s = stats.hashrate_60s;
+    header->hashrate_15m = stats.hashrate_15m;
+    header->hashrate_max = stats.max_hashrate;
+    header->paused = miner.is_paused() ? 1 : 0;
+
+    int count = std::min<int>(thread_count, stats.threads.size());
+    header->thread_count = count;
+    for (int i = 0; i < count; i++) {
+        const ThreadSnapshot& t = stats.threads[i];
+        ShmThreadStats& out = threads[i];
+        out.hashrate_10s = t.hashrate_10s;
+        out.hashrate_60s = t.hashrate_60s;
+        out.hashrate_15m = t.hashrate_15m;
+        out.hashes = t.hashes;
+        out.jobs = t.jobs;
+        out.pool = t.pool;
+        out.tier = t.tier;
+        out.phase = t.phase;
+        out.job_rtt_p50_ms = t.job_rtt.p50_ms;
+        out.job_rtt_p99_ms = t.job_rtt.p99_ms;
+        out.submit_rtt_p50_ms = t.submit_rtt.p50_ms;
+        out.submit_rtt_p99_ms = t.submit_rtt.p99_ms;
+        out.solve_p50_ms = t.solve_time.p50_ms;
+        out.solve_p99_ms = t.solve_time.p99_ms;
+    }
+
+    header->seq.store(seq + 2, std::memory_order_release);
+}
@@ -1,8 +1,15 @@
 #include "../include/stats.h"
+#include "../include/network.h"
+#include "../include/miner.h"
+#include "../include/logger.h"
 #include <iostream>
 #include <fstream>
 #include <sstream>
 #include <iomanip>
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
 #include <unistd.h>
 #include <vector>
 
@@ -29,68 +36,239 @@ std::string SystemStats::get_uptime() const {
     return ss.str();
 }
 
-double SystemStats::get_cpu_usage() const {
-    static unsigned long long last_total = 0;
-    static unsigned long long last_idle = 0;
-    
-    std::ifstream stat_file("/proc/stat");
-    if (!stat_file.is_open()) {
-        return 0.0;
+// Reads a /proc file from the start into buf; /proc regenerates the
+// contents on every read at offset 0
+static bool read_proc(int fd, char* buf, size_t size) {
+    if (fd < 0) return false;
+    ssize_t n = pread(fd, buf, size - 1, 0);
+    if (n <= 0) return false;
+    buf[n] = '\0';
+    return true;
+}
+
+// utime + stime from a /proc/<pid>/stat line; the command name may contain
+// spaces, so fields are counted from its closing parenthesis
+static bool parse_task_ticks(const char* buf, unsigned long long& ticks) {
+    const char* p = strrchr(buf, ')');
+    if (!p) return false;
+    unsigned long long utime, stime;
+    if (sscanf(p + 2, "%*c %*d %*d %*d %*d %*d %*u %*u %*u %*u %*u %llu %llu",
+               &utime, &stime) != 2) {
+        return false;
+    }
+    ticks = utime + stime;
+    return true;
+}
+
+SystemStats::~SystemStats() {
+    stop_sampler();
+}
+
+void SystemStats::start_sampler(const Miner& m, int interval_seconds) {
+    miner = &m;
+    interval = std::max(interval_seconds, 1);
+    stat_fd = open("/proc/stat", O_RDONLY | O_CLOEXEC);
+    self_fd = open("/proc/self/stat", O_RDONLY | O_CLOEXEC);
+    pressure_fd = open("/proc/pressure/cpu", O_RDONLY | O_CLOEXEC);
+    const std::string& cgroup = m.cpu_limits().cpu_dir;
+    if (!cgroup.empty()) {
+        cpu_stat_fd = open((cgroup + "/cpu.stat").c_str(), O_RDONLY | O_CLOEXEC);
     }
     
-    std::string line;
-    std::getline(stat_file, line);
-    stat_file.close();
+    // Baseline, so the first published sample covers one full interval
+    sample();
+    running = true;
+    sampler_thread = std::thread(&SystemStats::run, this);
+}
+
+void SystemStats::stop_sampler() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        running = false;
+    }
+    cv.notify_all();
+    if (sampler_thread.joinable()) {
+        sampler_thread.join();
+    }
+    close_files();
+}
+
+void SystemStats::close_files() {
+    for (int* fd : {&stat_fd, &self_fd, &pressure_fd, &cpu_stat_fd}) {
+        if (*fd >= 0) close(*fd);
+        *fd = -1;
+    }
+    for (TaskFile& task : tasks) {
+        if (task.fd >= 0) close(task.fd);
+    }
+    tasks.clear();
+}
+
+void SystemStats::run() {
+    std::unique_lock<std::mutex> lock(mutex);
+    while (running) {
+        if (cv.wait_for(lock, std::chrono::seconds(interval), [this] { return !running; })) {
+            break;
+        }
+        lock.unlock();
+        sample();
+        lock.lock();
+    }
+}
+
+void SystemStats::sample() {
+    static const double ticks_per_second = sysconf(_SC_CLK_TCK);
+    char buf[1024];
+    CpuSample next;
     
-    std::istringstream ss(line);
-    std::string cpu;
-    unsigned long long user, nice, system, idle, iowait, irq, softirq, steal;
+    auto now = std::chrono::steady_clock::now();
+    double elapsed = std::chrono::duration<double>(now - last_time).count();
+    bool first = last_time.time_since_epoch().count() == 0;
+    last_time = now;
     
-    ss >> cpu >> user >> nice >> system >> idle >> iowait >> irq >> softirq >> steal;
+    // cpu  user nice system idle iowait irq softirq steal
+    unsigned long long v[8];
+    if (read_proc(stat_fd, buf, sizeof(buf)) &&
+        sscanf(buf, "cpu %llu %llu %llu %llu %llu %llu %llu %llu",
+               &v[0], &v[1], &v[2], &v[3], &v[4], &v[5], &v[6], &v[7]) == 8) {
+        unsigned long long total = v[0] + v[1] + v[2] + v[3] + v[4] + v[5] + v[6] + v[7];
+        unsigned long long idle = v[3] + v[4];
+        if (total > last_total) {
+            next.system_usage = 100.0 * (1.0 - (double)(idle - last_idle) / (total - last_total));
+        }
+        last_total = total;
+        last_idle = idle;
+    }
     
-    unsigned long long total = user + nice + system + idle + iowait + irq + softirq + steal;
-    unsigned long long total_idle = idle + iowait;
+    // some avg10=0.00 avg60=0.00 avg300=0.00 total=<us>
+    unsigned long long stall_us;
+    const char* some = read_proc(pressure_fd, buf, sizeof(buf)) ? strstr(buf, "total=") : nullptr;
+    if (some && sscanf(some, "total=%llu", &stall_us) == 1) {
+        if (!first && elapsed > 0) {
+            next.pressure = (stall_us - last_stall_us) / (elapsed * 1e4);
+        }
+        last_stall_us = stall_us;
+    }
     
-    if (last_total == 0) {
-        last_total = total;
-        last_idle = total_idle;
-        usleep(100000); // 100ms
-        return get_cpu_usage();
+    // Periods in which the cgroup ran out of quota; warned about at most
+    // once a minute
+    CpuThrottle throttle;
+    if (read_proc(cpu_stat_fd, buf, sizeof(buf)) && parse_cpu_stat(buf, throttle)) {
+        next.throttled_periods = throttle.throttled;
+        next.throttled_seconds = throttle.throttled_seconds;
+        if (!first && throttle.periods > last_periods) {
+            unsigned long long periods = throttle.periods - last_periods;
+            unsigned long long throttled = throttle.throttled - last_throttled;
+            next.throttled = 100.0 * throttled / periods;
+            if (throttled > 0 && now - throttle_warned >= std::chrono::minutes(1)) {
+                throttle_warned = now;
+                Logger::warning("CPU quota exhausted in " + std::to_string(throttled) + " of " +
+                                std::to_string(periods) + " periods, workers are throttled; "
+                                "fewer threads (-t) would keep the quota");
+            }
+        }
+        last_periods = throttle.periods;
+        last_throttled = throttle.throttled;
     }
     
-    unsigned long long total_diff = total - last_total;
-    unsigned long long idle_diff = total_idle - last_idle;
+    unsigned long long process = 0;
+    if (read_proc(self_fd, buf, sizeof(buf)) && parse_task_ticks(buf, process)) {
+        if (!first && elapsed > 0) {
+            next.process_usage = 100.0 * (process - last_process) / ticks_per_second / elapsed;
+        }
+    }
     
-    last_total = total;
-    last_idle = total_idle;
+    // Workers by thread id; a worker that was restarted gets a new task file,
+    // and the files of retired slots, gone from the snapshot, are closed
+    MiningStatsSnapshot stats = miner->get_stats();
+    uint64_t hashes = stats.hashes;
+    for (size_t i = stats.threads.size(); i < tasks.size(); i++) {
+        if (tasks[i].fd >= 0) close(tasks[i].fd);
+    }
+    tasks.resize(stats.threads.size());
+    size_t count = stats.threads.size();
+    next.thread_usage.assign(count, 0.0);
+    next.thread_cpu_seconds.assign(count, 0.0);
+    next.thread_hashes_per_cpu_second.assign(count, 0.0);
+    for (size_t i = 0; i < count; i++) {
+        const ThreadSnapshot& ts = stats.threads[i];
+        TaskFile& task = tasks[i];
+        if (ts.tid <= 0) continue;
+        if (task.tid != ts.tid) {
+            if (task.fd >= 0) close(task.fd);
+            std::string path = "/proc/self/task/" + std::to_string(ts.tid) + "/stat";
+            task = TaskFile();
+            task.tid = ts.tid;
+            task.fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+            task.hashes = ts.hashes;
+        }
+        
+        unsigned long long ticks;
+        if (!read_proc(task.fd, buf, sizeof(buf)) || !parse_task_ticks(buf, ticks)) continue;
+        next.thread_cpu_seconds[i] = ticks / ticks_per_second;
+        if (task.read && elapsed > 0) {
+            double cpu = (ticks - task.ticks) / ticks_per_second;
+            next.thread_usage[i] = 100.0 * cpu / elapsed;
+            if (cpu > 0) {
+                next.thread_hashes_per_cpu_second[i] = (ts.hashes - task.hashes) / cpu;
+            }
+        }
+        task.read = true;
+        task.ticks = ticks;
+        task.hashes = ts.hashes;
+    }
     
-    if (total_diff == 0) {
-        return 0.0;
+    // Per second of CPU the whole process used, so reporter, logger and
+    // network overhead count against the hashes
+    if (!first && process > last_process) {
+        next.hashes_per_cpu_second =
+            (hashes - last_hashes) / ((process - last_process) / ticks_per_second);
     }
+    last_process = process;
+    last_hashes = hashes;
     
-    return 100.0 * (1.0 - static_cast<double>(idle_diff) / static_cast<double>(total_diff));
+    if (first) return;
+    std::lock_guard<std::mutex> lock(sample_mutex);
+    current = std::move(next);
 }
 
-std::string SystemStats::get_cpu_name() const {
-    std::ifstream cpuinfo("/proc/cpuinfo");
-    std::string line;
-    
-    while (std::getline(cpuinfo, line)) {
-        if (line.find("model name") != std::string::npos) {
-            size_t pos = line.find(":");
-            if (pos != std::string::npos) {
-                std::string name = line.substr(pos + 2);
-                // Trim whitespace
-                size_t start = name.find_first_not_of(" \t");
-                size_t end = name.find_last_not_of(" \t");
-                if (start != std::string::npos && end != std::string::npos) {
-                    return name.substr(start, end - start + 1);
+CpuSample SystemStats::get_sample() const {
+    std::lock_guard<std::mutex> lock(sample_mutex);
+    return current;
+}
+
+double SystemStats::get_cpu_usage() const {
+    std::lock_guard<std::mutex> lock(sample_mutex);
+    return current.system_usage;
+}
+
+const std::string& SystemStats::cpu_name() {
+    static const std::string name = [] {
+        std::ifstream cpuinfo("/proc/cpuinfo");
+        std::string line;
+        
+        while (std::getline(cpuinfo, line)) {
+            if (line.find("model name") != std::string::npos) {
+                size_t pos = line.find(":");
+                if (pos != std::string::npos) {
+                    std::string name = line.substr(pos + 2);
+                    // Trim whitespace
+                    size_t start = name.find_first_not_of(" \t");
+                    size_t end = name.find_last_not_of(" \t");
+                    if (start != std::string::npos && end != std::string::npos) {
+                        return name.substr(start, end - start + 1);
+                    }
                 }
             }
         }
-    }
-    
-    return "Unknown CPU";
+        
+        return std::string("Unknown CPU");
+    }();
+    return name;
+}
+
+std::string SystemStats::get_cpu_name() const {
+    return cpu_name();
 }
 
 std::string StatsDisplay::format_bytes(unsigned long bytes) {
@@ -131,7 +309,8 @@ void StatsDisplay::show_stats(const SystemStats& sys_stats,
                               unsigned long accepted,
                               unsigned long rejected,
                               const std::string& pool_address,
-                              int pool_port) {
+                              int pool_port,
+                              const IoSnapshot& io) {
     std::cout << "\n";
     std::cout << "================================ STATS ================================\n";
     
@@ -154,10 +333,9 @@ void StatsDisplay::show_stats(const SystemStats& sys_stats,
     std::cout << "\n";
     
     // Data usage
-    unsigned long total_data = sys_stats.data_bytes_sent.load() + sys_stats.data_bytes_received.load();
-    std::cout << "Data Used:     " << format_bytes(total_data) 
-              << " (Sent: " << format_bytes(sys_stats.data_bytes_sent.load())
-              << " | Received: " << format_bytes(sys_stats.data_bytes_received.load()) << ")\n";
+    std::cout << "Data Used:     " << format_bytes(io.bytes_sent + io.bytes_received) 
+              << " (Sent: " << format_bytes(io.bytes_sent)
+              << " | Received: " << format_bytes(io.bytes_received) << ")\n";
     
     // Pool info
     std::cout << "Pool:          " << pool_address << ":" << pool_port << "\n";
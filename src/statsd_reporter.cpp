@@ -0,0 +1,169 @@
+#include "../include/statsd_reporter.h"
+#include "../include/logger.h"
+#include <sstream>
+#include <iomanip>
+#include <algorithm>
+#include <cstring>
+#include <cerrno>
+#include <unistd.h>
+#include <netdb.h>
+#include <sys/socket.h>
+
+StatsdReporter::StatsdReporter(const Config& cfg, const Miner& miner)
+    : config(cfg), miner(miner) {}
+
+StatsdReporter::~StatsdReporter() {
+    stop();
+}
+
+bool StatsdReporter::start(const std::string& host, int port) {
+    struct addrinfo hints, *res;
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_DGRAM;
+
+    if (getaddrinfo(host.c_str(), std::to_string(port).c_str(), &hints, &res) != 0) {
+        Logger::error("StatsD: cannot resolve " + host);
+        return false;
+    }
+
+    // A connected UDP socket: plain send() and no per-packet address lookup
+    for (struct addrinfo* p = res; p; p = p->ai_next) {
+        int fd = socket(p->ai_family, p->ai_socktype | SOCK_NONBLOCK | SOCK_CLOEXEC,
+                        p->ai_protocol);
+        if (fd < 0) continue;
+        if (::connect(fd, p->ai_addr, p->ai_addrlen) == 0) {
+            sockfd = fd;
+            break;
+        }
+        close(fd);
+    }
+    freeaddrinfo(res);
+
+    if (sockfd < 0) {
+        Logger::error("StatsD: cannot open socket to " + host);
+        return false;
+    }
+
+    running = true;
+    reporter_thread = std::thread(&StatsdReporter::run, this);
+    Logger::info("StatsD push to " + host + ":" + std::to_string(port) + " every " +
+                 std::to_string(config.report_interval) + "s");
+    return true;
+}
+
+void StatsdReporter::stop() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        running = false;
+    }
+    cv.notify_all();
+    if (reporter_thread.joinable()) {
+        reporter_thread.join();
+    }
+    if (sockfd >= 0) {
+        close(sockfd);
+        sockfd = -1;
+    }
+}
+
+void StatsdReporter::run() {
+    int interval = std::max(config.report_interval, 1);
+    std::unique_lock<std::mutex> lock(mutex);
+    while (running) {
+        if (cv.wait_for(lock, std::chrono::seconds(interval), [this] { return !running; })) {
+            break;
+        }
+        lock.unlock();
+        push();
+        lock.lock();
+    }
+}
+
+std::string StatsdReporter::metric(const std::string& name, double value, const char* type,
+                                   const std::string& tags) const {
+    std::ostringstream line;
+    line << config.statsd_prefix;
+    if (config.statsd_format == "statsd") {
+        // No tag support: rig.thread.N.name
+        line << "." << config.rig_identifier;
+        if (!tags.empty()) line << "." << tags;
+        line << "." << name;
+    } else {
+        line << "." << name;
+    }
+    line << ":" << std::setprecision(10) << value << "|" << type;
+    if (config.statsd_format != "statsd") {
+        line << "|#rig:" << config.rig_identifier;
+        if (!tags.empty()) {
+            std::string t = tags;
+            // thread.3 -> thread:3
+            size_t dot = t.find('.');
+            if (dot != std::string::npos) t[dot] = ':';
+            line << "," << t;
+        }
+    }
+    return line.str();
+}
+
+void StatsdReporter::push() {
+    MiningStatsSnapshot stats = miner.get_stats();
+    std::vector<std::string> lines;
+
+    lines.push_back(metric("hashrate.10s", stats.hashrate_10s, "g", ""));
+    lines.push_back(metric("hashrate.60s", stats.hashrate_60s, "g", ""));
+    lines.push_back(metric("hashrate.15m", stats.hashrate_15m, "g", ""));
+    lines.push_back(metric("shares.accepted", stats.accepted - last_accepted, "c", ""));
+    lines.push_back(metric("shares.rejected", stats.rejected - last_rejected, "c", ""));
+    lines.push_back(metric("blocks", stats.blocks - last_blocks, "c", ""));
+    lines.push_back(metric("threads", stats.workers, "g", ""));
+    lines.push_back(metric("paused", miner.is_paused() ? 1 : 0, "g", ""));
+    last_accepted = stats.accepted;
+    last_rejected = stats.rejected;
+    last_blocks = stats.blocks;
+
+    last_hashes.resize(stats.threads.size(), 0);
+    for (size_t i = 0; i < stats.threads.size(); i++) {
+        const ThreadSnapshot& t = stats.threads[i];
+        std::string tag = "thread." + std::to_string(i);
+        lines.push_back(metric("thread.hashrate", t.hashrate_60s, "g", tag));
+        lines.push_back(metric("thread.hashes", t.hashes - last_hashes[i], "c", tag));
+        lines.push_back(metric("thread.job_rtt.p50", t.job_rtt.p50_ms, "g", tag));
+        lines.push_back(metric("thread.job_rtt.p99", t.job_rtt.p99_ms, "g", tag));
+        lines.push_back(metric("thread.submit_rtt.p50", t.submit_rtt.p50_ms, "g", tag));
+        lines.push_back(metric("thread.submit_rtt.p99", t.submit_rtt.p99_ms, "g", tag));
+        lines.push_back(metric("thread.solve.p50", t.solve_time.p50_ms, "g", tag));
+        last_hashes[i] = t.hashes;
+    }
+
+    send_batch(lines);
+}
+
+void StatsdReporter::send_batch(const std::vector<std::string>& lines) {
+    size_t mtu = std::max(config.statsd_mtu, 512);
+    std::string packet;
+    packet.reserve(mtu);
+
+    auto flush = [&]() {
+        if (packet.empty()) return true;
+        ssize_t n = send(sockfd, packet.data(), packet.length(), MSG_DONTWAIT | MSG_NOSIGNAL);
+        packet.clear();
+        if (n < 0 && errno != ECONNREFUSED) {
+            return false;
+        }
+        return true;
+    };
+
+    for (size_t i = 0; i < lines.size(); i++) {
+        if (!packet.empty() && packet.length() + 1 + lines[i].length() > mtu) {
+            if (!flush()) {
+                Logger::warning("StatsD: send buffer full, dropped " +
+                                std::to_string(lines.size() - i) + " metrics");
+                return;
+            }
+        }
+        if (!packet.empty()) packet += '\n';
+        packet += lines[i];
+    }
+    flush();
+}
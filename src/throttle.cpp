@@ -0,0 +1,100 @@
+#include "../include/throttle.h"
+#include <algorithm>
+#include <time.h>
+#include <errno.h>
+
+static int64_t to_ns(const struct timespec& ts) {
+    return (int64_t)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+int64_t Throttle::wall_ns() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return to_ns(ts);
+}
+
+int64_t Throttle::thread_cpu_ns() {
+    struct timespec ts;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return to_ns(ts);
+}
+
+Throttle::Throttle(int duty_percent, double max_hashrate)
+    : duty_percent(std::min(std::max(duty_percent, 1), 100)),
+      max_hashrate(max_hashrate),
+      active(duty_percent < 100 || max_hashrate > 0),
+      batch_size(THROTTLE_MAX_BATCH) {
+    if (active) {
+        batch_size = THROTTLE_MIN_BATCH;
+    }
+}
+
+void Throttle::restart(int64_t wall, int64_t cpu) {
+    wall_start = wall;
+    cpu_start = cpu;
+    hashes = 0;
+}
+
+void Throttle::set_max_hashrate(double rate) {
+    max_hashrate = rate;
+    active = duty_percent < 100 || max_hashrate > 0;
+    if (active) batch_size = std::min<uint64_t>(batch_size, THROTTLE_MIN_BATCH);
+    wall_start = 0;
+}
+
+void Throttle::tick(uint64_t batch_hashes) {
+    if (!active) return;
+
+    int64_t wall = wall_ns();
+    int64_t cpu = thread_cpu_ns();
+
+    if (wall_start == 0) {
+        restart(wall, cpu);
+        last_cpu = cpu;
+        last_wall = wall;
+        return;
+    }
+
+    hashes += batch_hashes;
+
+    // Size the next batch so that one control step costs ~THROTTLE_BATCH_NS
+    // of hashing; the two clock reads are then negligible.
+    int64_t batch_cpu = cpu - last_cpu;
+    if (batch_cpu > 0 && batch_hashes > 0) {
+        double ns_per_hash = (double)batch_cpu / batch_hashes;
+        uint64_t next = (uint64_t)(THROTTLE_BATCH_NS / ns_per_hash);
+        batch_size = std::min<uint64_t>(std::max<uint64_t>(next, THROTTLE_MIN_BATCH),
+                                        THROTTLE_MAX_BATCH);
+    }
+
+    // Wall time the work done so far is allowed to take
+    int64_t target = 0;
+    if (duty_percent < 100) {
+        target = (cpu - cpu_start) * 100 / duty_percent;
+    }
+    if (max_hashrate > 0) {
+        target = std::max(target, (int64_t)(hashes * 1e9 / max_hashrate));
+    }
+
+    // Time spent blocked elsewhere (network, pause) must not be banked and
+    // later burnt at 100% CPU
+    int64_t elapsed = wall - wall_start;
+    if (elapsed - target > THROTTLE_MAX_CREDIT_NS) {
+        wall_start = wall - target - THROTTLE_MAX_CREDIT_NS;
+        elapsed = target + THROTTLE_MAX_CREDIT_NS;
+    }
+
+    if (target > elapsed) {
+        int64_t deadline = wall_start + target;
+        struct timespec ts;
+        ts.tv_sec = deadline / 1000000000LL;
+        ts.tv_nsec = deadline % 1000000000LL;
+        while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, nullptr) == EINTR) {}
+        int64_t woke = wall_ns();
+        slept_ns += woke - wall;
+        wall = woke;
+    }
+
+    last_wall = wall;
+    last_cpu = thread_cpu_ns();
+}
@@ -0,0 +1,299 @@
+#include "../include/topology.h"
+#include <fstream>
+#include <sstream>
+#include <algorithm>
+#include <map>
+#include <set>
+#include <thread>
+#include <sched.h>
+
+static bool read_line(const std::string& path, std::string& line) {
+    std::ifstream file(path);
+    return file.is_open() && std::getline(file, line);
+}
+
+static int read_int(const std::string& path, int fallback) {
+    std::string line;
+    if (!read_line(path, line)) return fallback;
+    try {
+        return std::stoi(line);
+    } catch (...) {
+        return fallback;
+    }
+}
+
+// "0-3,8,10-11"
+std::vector<int> Topology::parse_list(const std::string& text) {
+    std::vector<int> cpus;
+    std::stringstream ss(text);
+    std::string range;
+    while (std::getline(ss, range, ',')) {
+        if (range.empty() || range == "\n") continue;
+        try {
+            size_t dash = range.find('-');
+            int first = std::stoi(range.substr(0, dash));
+            int last = dash == std::string::npos ? first : std::stoi(range.substr(dash + 1));
+            for (int cpu = first; cpu <= last; cpu++) cpus.push_back(cpu);
+        } catch (...) {
+            continue;
+        }
+    }
+    return cpus;
+}
+
+bool Topology::load(const std::string& root) {
+    cpus.clear();
+    node_count = 1;
+    std::string cpu_dir = root + "/sys/devices/system/cpu/";
+    std::string node_dir = root + "/sys/devices/system/node/";
+
+    std::string line;
+    std::vector<int> online;
+    if (read_line(cpu_dir + "online", line)) {
+        online = parse_list(line);
+    }
+    bool found = !online.empty();
+    if (!found) {
+        int count = std::max(1u, std::thread::hardware_concurrency());
+        for (int i = 0; i < count; i++) online.push_back(i);
+    }
+
+    for (int id : online) {
+        CpuInfo info;
+        info.cpu = id;
+        std::string topo = cpu_dir + "cpu" + std::to_string(id) + "/topology/";
+        info.core = read_int(topo + "core_id", id);
+        info.package = std::max(read_int(topo + "physical_package_id", 0), 0);
+        cpus.push_back(info);
+    }
+
+    std::vector<int> node_ids;
+    if (read_line(node_dir + "online", line)) {
+        node_ids = parse_list(line);
+    }
+    for (int node : node_ids) {
+        if (!read_line(node_dir + "node" + std::to_string(node) + "/cpulist", line)) continue;
+        for (int id : parse_list(line)) {
+            for (CpuInfo& info : cpus) {
+                if (info.cpu == id) info.node = node;
+            }
+        }
+    }
+    if (!node_ids.empty()) node_count = node_ids.size();
+
+    detect_classes(root);
+    count_classes();
+    group_cores();
+    return found;
+}
+
+void Topology::restrict(const CpuLimits& limits) {
+    size_t before = cpus.size();
+    cpus.erase(std::remove_if(cpus.begin(), cpus.end(),
+                              [&](const CpuInfo& info) { return !limits.allows(info.cpu); }),
+               cpus.end());
+    if (cpus.size() == before) return;
+    count_classes();
+    group_cores();
+}
+
+void Topology::detect_classes(const std::string& root) {
+    std::string cpu_dir = root + "/sys/devices/system/cpu/";
+    bool have_capacity = false;
+    int max_capacity = 0;
+    for (CpuInfo& info : cpus) {
+        int capacity = read_int(cpu_dir + "cpu" + std::to_string(info.cpu) + "/cpu_capacity", -1);
+        if (capacity > 0) {
+            info.capacity = capacity;
+            have_capacity = true;
+        }
+        max_capacity = std::max(max_capacity, info.capacity);
+    }
+
+    std::string line;
+    if (read_line(root + "/sys/devices/cpu_atom/cpus", line)) {
+        for (int id : parse_list(line)) {
+            for (CpuInfo& info : cpus) {
+                if (info.cpu == id) info.core_class = CORE_EFFICIENCY;
+            }
+        }
+    } else if (have_capacity) {
+        for (CpuInfo& info : cpus) {
+            if (info.capacity < max_capacity) info.core_class = CORE_EFFICIENCY;
+        }
+    }
+}
+
+void Topology::count_classes() {
+    for (int& count : class_count) count = 0;
+    for (const CpuInfo& info : cpus) class_count[info.core_class]++;
+}
+
+double Topology::relative_capacity(int core_class) const {
+    double sum[CORE_CLASS_COUNT] = {};
+    bool reported = false;
+    for (const CpuInfo& info : cpus) {
+        sum[info.core_class] += info.capacity;
+        reported |= info.capacity != 1024;
+    }
+    if (!reported || class_count[core_class] == 0 || class_count[CORE_PERFORMANCE] == 0) {
+        return 0.0;
+    }
+    return (sum[core_class] / class_count[core_class]) /
+           (sum[CORE_PERFORMANCE] / class_count[CORE_PERFORMANCE]);
+}
+
+const char* Topology::class_name(int core_class) {
+    return core_class == CORE_EFFICIENCY ? "E" : "P";
+}
+
+void Topology::group_cores() {
+    std::sort(cpus.begin(), cpus.end(),
+              [](const CpuInfo& a, const CpuInfo& b) { return a.cpu < b.cpu; });
+
+    // Siblings share (package, core_id); ordered by class, node, then by the
+    // lowest CPU number of the core
+    std::map<std::pair<int, int>, int> index;
+    core_cpus.clear();
+    for (CpuInfo& info : cpus) {
+        auto key = std::make_pair(info.package, info.core);
+        auto it = index.find(key);
+        if (it == index.end()) {
+            it = index.emplace(key, core_cpus.size()).first;
+            core_cpus.emplace_back();
+        }
+        info.sibling = core_cpus[it->second].size();
+        core_cpus[it->second].push_back(info.cpu);
+    }
+    std::stable_sort(core_cpus.begin(), core_cpus.end(),
+                     [this](const std::vector<int>& a, const std::vector<int>& b) {
+                         const CpuInfo* x = find(a[0]);
+                         const CpuInfo* y = find(b[0]);
+                         if (x->core_class != y->core_class) return x->core_class < y->core_class;
+                         return x->node < y->node;
+                     });
+}
+
+const CpuInfo* Topology::find(int cpu) const {
+    auto it = std::lower_bound(cpus.begin(), cpus.end(), cpu,
+                               [](const CpuInfo& info, int id) { return info.cpu < id; });
+    return it != cpus.end() && it->cpu == cpu ? &*it : nullptr;
+}
+
+bool Topology::valid_policy(const std::string& policy) {
+    return policy == "scatter" || policy == "compact" || policy == "physical" ||
+           policy == "none";
+}
+
+std::vector<int> Topology::place(const std::string& policy, int count) const {
+    std::vector<int> order;
+    if (policy == "none" || core_cpus.empty() || count <= 0) return order;
+
+    if (policy == "compact") {
+        for (const auto& core : core_cpus) {
+            order.insert(order.end(), core.begin(), core.end());
+        }
+    } else {
+        // Per class, cores of each node in order, then taken round-robin
+        // across nodes
+        for (int core_class = 0; core_class < CORE_CLASS_COUNT; core_class++) {
+            std::map<int, std::vector<const std::vector<int>*>> by_node;
+            size_t max_siblings = 0;
+            for (const auto& core : core_cpus) {
+                const CpuInfo* info = find(core[0]);
+                if (info->core_class != core_class) continue;
+                by_node[info->node].push_back(&core);
+                max_siblings = std::max(max_siblings, core.size());
+            }
+            size_t levels = policy == "physical" ? 1 : max_siblings;
+            for (size_t sibling = 0; sibling < levels; sibling++) {
+                for (size_t rank = 0; ; rank++) {
+                    bool any = false;
+                    for (const auto& node : by_node) {
+                        if (rank >= node.second.size()) continue;
+                        any = true;
+                        const std::vector<int>& core = *node.second[rank];
+                        if (sibling < core.size()) order.push_back(core[sibling]);
+                    }
+                    if (!any) break;
+                }
+            }
+        }
+    }
+
+    std::vector<int> placement;
+    for (int i = 0; i < count; i++) {
+        placement.push_back(order[i % order.size()]);
+    }
+    return placement;
+}
+
+std::vector<int> Topology::spare(const std::vector<int>& used) const {
+    std::set<int> taken(used.begin(), used.end());
+    std::vector<int> idle_cores;
+    std::vector<int> idle_cpus;
+    for (const auto& core : core_cpus) {
+        bool busy = false;
+        for (int cpu : core) busy |= taken.count(cpu) > 0;
+        for (int cpu : core) {
+            if (taken.count(cpu)) continue;
+            (busy ? idle_cpus : idle_cores).push_back(cpu);
+        }
+    }
+    std::vector<int>& result = idle_cores.empty() ? idle_cpus : idle_cores;
+    std::sort(result.begin(), result.end());
+    return result;
+}
+
+std::string Topology::describe() const {
+    std::set<int> packages;
+    for (const CpuInfo& info : cpus) packages.insert(info.package);
+    std::ostringstream ss;
+    ss << cpus.size() << " CPUs, " << core_cpus.size() << " cores, "
+       << packages.size() << (packages.size() == 1 ? " package, " : " packages, ")
+       << node_count << (node_count == 1 ? " NUMA node" : " NUMA nodes");
+    if (hybrid()) {
+        ss << ", " << class_count[CORE_PERFORMANCE] << " P + "
+           << class_count[CORE_EFFICIENCY] << " E CPUs";
+    }
+    return ss.str();
+}
+
+bool Topology::pin(pthread_t thread, const std::vector<int>& cpu_list) {
+#ifdef __linux__
+    if (cpu_list.empty()) return true;
+    // Sized to the highest CPU, so machines past CPU_SETSIZE (1024) work too
+    int count = *std::max_element(cpu_list.begin(), cpu_list.end()) + 1;
+    cpu_set_t* set = CPU_ALLOC(count);
+    if (!set) return false;
+    size_t size = CPU_ALLOC_SIZE(count);
+    CPU_ZERO_S(size, set);
+    for (int cpu : cpu_list) {
+        if (cpu >= 0) CPU_SET_S(cpu, size, set);
+    }
+    bool ok = pthread_setaffinity_np(thread, size, set) == 0;
+    CPU_FREE(set);
+    return ok;
+#else
+    (void)thread;
+    (void)cpu_list;
+    return true;
+#endif
+}
+
+std::string Topology::format_list(const std::vector<int>& cpu_list) {
+    std::vector<int> sorted(cpu_list);
+    std::sort(sorted.begin(), sorted.end());
+    sorted.erase(std::unique(sorted.begin(), sorted.end()), sorted.end());
+
+    std::ostringstream ss;
+    for (size_t i = 0; i < sorted.size(); ) {
+        size_t j = i;
+        while (j + 1 < sorted.size() && sorted[j + 1] == sorted[j] + 1) j++;
+        if (i > 0) ss << ",";
+        ss << sorted[i];
+        if (j > i) ss << "-" << sorted[j];
+        i = j + 1;
+    }
+    return ss.str();
+}
@@ -0,0 +1,174 @@
+#include "../include/trace.h"
+#include "../include/logger.h"
+#include <atomic>
+#include <memory>
+#include <vector>
+#include <mutex>
+#include <fstream>
+#include <algorithm>
+#include <cstdio>
+#include <time.h>
+
+namespace {
+
+// Names and arg names must be string literals (only the pointer is stored)
+struct TraceEvent {
+    int64_t ts_ns;
+    int64_t dur_ns;
+    const char* name;
+    const char* arg_name;
+    int64_t arg;
+    char phase;
+};
+
+// A ring slot. dump() may read a slot while its worker overwrites it, so
+// the fields are relaxed atomics (plain moves on x86/ARM) and the torn copy
+// is detected afterwards from head, seqlock style.
+struct TraceSlot {
+    std::atomic<int64_t> ts_ns;
+    std::atomic<int64_t> dur_ns;
+    std::atomic<const char*> name;
+    std::atomic<const char*> arg_name;
+    std::atomic<int64_t> arg;
+    std::atomic<char> phase;
+
+    void store(const TraceEvent& e) {
+        ts_ns.store(e.ts_ns, std::memory_order_relaxed);
+        dur_ns.store(e.dur_ns, std::memory_order_relaxed);
+        name.store(e.name, std::memory_order_relaxed);
+        arg_name.store(e.arg_name, std::memory_order_relaxed);
+        arg.store(e.arg, std::memory_order_relaxed);
+        phase.store(e.phase, std::memory_order_relaxed);
+    }
+
+    TraceEvent load() const {
+        return {ts_ns.load(std::memory_order_relaxed), dur_ns.load(std::memory_order_relaxed),
+                name.load(std::memory_order_relaxed), arg_name.load(std::memory_order_relaxed),
+                arg.load(std::memory_order_relaxed), phase.load(std::memory_order_relaxed)};
+    }
+};
+
+struct alignas(64) TraceRing {
+    std::unique_ptr<TraceSlot[]> events;
+    std::atomic<uint64_t> head{0};
+};
+
+std::unique_ptr<TraceRing[]> rings;
+int ring_count = 0;
+uint64_t ring_mask = 0;
+std::string trace_file;
+int64_t trace_start = 0;
+std::mutex dump_mutex;
+
+int64_t monotonic_ns() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+}
+
+bool Trace::enable(const std::string& file, int threads, size_t events_per_thread) {
+    if (enabled || file.empty() || threads <= 0) return false;
+
+    size_t capacity = 1024;
+    while (capacity < events_per_thread) capacity <<= 1;
+
+    rings.reset(new TraceRing[threads]);
+    for (int i = 0; i < threads; i++) {
+        rings[i].events.reset(new TraceSlot[capacity]());
+    }
+    ring_count = threads;
+    ring_mask = capacity - 1;
+    trace_file = file;
+    trace_start = monotonic_ns();
+    enabled = true;
+
+    Logger::info("Tracing to " + file + " (" + std::to_string(capacity) +
+                 " events per thread)");
+    return true;
+}
+
+void Trace::record(int thread, char phase, const char* name, int64_t ts_ns,
+                   int64_t dur_ns, const char* arg_name, int64_t arg) {
+    if (thread < 0 || thread >= ring_count) return;
+    TraceRing& ring = rings[thread];
+
+    // Single writer per ring. The fence orders the previous head store
+    // before the slot stores, so a reader that sees any of them also sees
+    // head past the event whose slot is being reused.
+    uint64_t head = ring.head.load(std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    ring.events[head & ring_mask].store({ts_ns, dur_ns, name, arg_name, arg, phase});
+    ring.head.store(head + 1, std::memory_order_release);
+}
+
+bool Trace::dump() {
+    if (!enabled) return false;
+    std::lock_guard<std::mutex> lock(dump_mutex);
+
+    std::string tmp = trace_file + ".tmp";
+    std::ofstream out(tmp);
+    if (!out) {
+        Logger::error("Cannot write trace file: " + trace_file);
+        return false;
+    }
+
+    uint64_t capacity = ring_mask + 1;
+    size_t written = 0;
+    char line[256];
+
+    out << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n";
+    out << "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"args\":{\"name\":\"duino-cpu\"}}";
+
+    for (int t = 0; t < ring_count; t++) {
+        TraceRing& ring = rings[t];
+        out << ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << t
+            << ",\"args\":{\"name\":\"worker " << t << "\"}}";
+
+        uint64_t end = ring.head.load(std::memory_order_acquire);
+        uint64_t begin = end > capacity ? end - capacity : 0;
+        std::vector<TraceEvent> copy;
+        copy.reserve(end - begin);
+        for (uint64_t i = begin; i < end; i++) {
+            copy.push_back(ring.events[i & ring_mask].load());
+        }
+
+        // Slots the worker wrapped onto while we were copying are torn; the
+        // fence keeps the slot loads above from moving past the head load
+        std::atomic_thread_fence(std::memory_order_acquire);
+        uint64_t now = ring.head.load(std::memory_order_acquire);
+        uint64_t valid = now >= capacity ? now - capacity + 1 : 0;
+        size_t skip = valid > begin ? std::min<uint64_t>(valid - begin, copy.size()) : 0;
+
+        for (size_t i = skip; i < copy.size(); i++) {
+            const TraceEvent& e = copy[i];
+            int len = snprintf(line, sizeof(line),
+                               ",\n{\"name\":\"%s\",\"ph\":\"%c\",\"pid\":1,\"tid\":%d,"
+                               "\"ts\":%.3f",
+                               e.name, e.phase, t, (e.ts_ns - trace_start) / 1000.0);
+            if (e.phase == 'X') {
+                len += snprintf(line + len, sizeof(line) - len, ",\"dur\":%.3f",
+                                e.dur_ns / 1000.0);
+            } else {
+                len += snprintf(line + len, sizeof(line) - len, ",\"s\":\"t\"");
+            }
+            if (e.arg_name) {
+                len += snprintf(line + len, sizeof(line) - len, ",\"args\":{\"%s\":%lld}",
+                                e.arg_name, (long long)e.arg);
+            }
+            out.write(line, len);
+            out << "}";
+            written++;
+        }
+    }
+    out << "\n]}\n";
+    out.close();
+
+    if (!out || rename(tmp.c_str(), trace_file.c_str()) != 0) {
+        Logger::error("Cannot write trace file: " + trace_file);
+        return false;
+    }
+    Logger::info("Trace written: " + trace_file + " (" + std::to_string(written) + " events)");
+    return true;
+}
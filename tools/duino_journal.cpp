@@ -0,0 +1,157 @@
+// Converts share journals (journal_file) to CSV or JSON lines for
+// spreadsheets, pandas or jq. Pass rotated files oldest first to get one
+// continuous timeline.
+#include "../include/share_journal.h"
+#include "../include/json.h"
+#include <getopt.h>
+#include <cstdio>
+#include <cstring>
+#include <cerrno>
+#include <ctime>
+#include <string>
+#include <vector>
+
+static const char* type_names[] = {"pool", "job", "share"};
+static const char* verdict_names[] = {"", "accepted", "rejected", "block", "lost"};
+
+static void print_usage(const char* program_name) {
+    printf("Usage: %s [OPTIONS] <journal> [journal...]\n\n", program_name);
+    printf("Options:\n");
+    printf("  -f, --format <csv|json>     Output format, JSON is one object per line (default: csv)\n");
+    printf("  -s, --shares                Shares only, no job records\n");
+    printf("  -h, --help                  Show this help message\n\n");
+}
+
+// 2026-10-19T12:34:56.789012Z
+static std::string format_time(uint64_t time_us) {
+    time_t seconds = time_us / 1000000;
+    struct tm tm;
+    gmtime_r(&seconds, &tm);
+    char buf[48];
+    size_t len = strftime(buf, sizeof(buf), "%Y-%m-%dT%H:%M:%S", &tm);
+    snprintf(buf + len, sizeof(buf) - len, ".%06uZ", (unsigned)(time_us % 1000000));
+    return buf;
+}
+
+static std::string csv_field(const std::string& value) {
+    if (value.find_first_of(",\"\n") == std::string::npos) return value;
+    std::string quoted = "\"";
+    for (char c : value) {
+        if (c == '"') quoted += '"';
+        quoted += c;
+    }
+    return quoted + "\"";
+}
+
+static void print_record(const JournalRecord& r, const std::string& pool, bool json) {
+    std::string text(r.text, strnlen(r.text, sizeof(r.text)));
+    const char* verdict = r.verdict < sizeof(verdict_names) / sizeof(verdict_names[0]) ?
+                          verdict_names[r.verdict] : "unknown";
+
+    if (json) {
+        printf("{\"time\":\"%s\",\"type\":\"%s\",\"thread\":%u,\"pool\":%s,\"difficulty\":%u",
+               format_time(r.time_us).c_str(), type_names[r.type], r.thread,
+               Json::quote(pool).c_str(), r.difficulty);
+        printf(",\"job_rtt_ms\":%.3f", r.job_rtt_us / 1000.0);
+        if (r.type == JOURNAL_SHARE) {
+            printf(",\"nonce\":%u,\"solve_ms\":%.3f,\"submit_rtt_ms\":%.3f,\"verdict\":\"%s\","
+                   "\"reason\":%s",
+                   r.nonce, r.solve_us / 1000.0, r.submit_rtt_us / 1000.0, verdict,
+                   Json::quote(text).c_str());
+        }
+        printf("}\n");
+        return;
+    }
+
+    printf("%s,%s,%u,%s,%u,", format_time(r.time_us).c_str(), type_names[r.type], r.thread,
+           csv_field(pool).c_str(), r.difficulty);
+    if (r.type == JOURNAL_SHARE) {
+        printf("%u,%.3f,%.3f,%.3f,%s,%s\n", r.nonce, r.solve_us / 1000.0,
+               r.job_rtt_us / 1000.0, r.submit_rtt_us / 1000.0, verdict,
+               csv_field(text).c_str());
+    } else {
+        printf(",,%.3f,,,\n", r.job_rtt_us / 1000.0);
+    }
+}
+
+static bool dump_file(const char* path, bool json, bool shares_only) {
+    FILE* f = fopen(path, "rb");
+    if (!f) {
+        fprintf(stderr, "Cannot open %s: %s\n", path, strerror(errno));
+        return false;
+    }
+
+    JournalFileHeader header;
+    if (fread(&header, sizeof(header), 1, f) != 1 ||
+        memcmp(header.magic, JOURNAL_MAGIC, sizeof(header.magic)) != 0) {
+        fprintf(stderr, "%s is not a share journal\n", path);
+        fclose(f);
+        return false;
+    }
+    if (header.version != JOURNAL_VERSION || header.record_size != sizeof(JournalRecord)) {
+        fprintf(stderr, "%s: unsupported journal version %u\n", path, header.version);
+        fclose(f);
+        return false;
+    }
+
+    std::vector<std::string> pools;
+    JournalRecord r;
+    while (fread(&r, sizeof(r), 1, f) == 1) {
+        if (r.type == JOURNAL_POOL) {
+            if (r.pool >= pools.size()) pools.resize(r.pool + 1);
+            pools[r.pool] = std::string(r.text, strnlen(r.text, sizeof(r.text)));
+            continue;
+        }
+        if (r.type > JOURNAL_SHARE) continue;
+        if (shares_only && r.type != JOURNAL_SHARE) continue;
+        std::string pool = r.pool < pools.size() ? pools[r.pool] : std::to_string(r.pool);
+        print_record(r, pool, json);
+    }
+    fclose(f);
+    return true;
+}
+
+int main(int argc, char* argv[]) {
+    static struct option long_options[] = {
+        {"format", required_argument, 0, 'f'},
+        {"shares", no_argument, 0, 's'},
+        {"help", no_argument, 0, 'h'},
+        {0, 0, 0, 0}
+    };
+
+    bool json = false;
+    bool shares_only = false;
+
+    int opt;
+    while ((opt = getopt_long(argc, argv, "f:sh", long_options, nullptr)) != -1) {
+        switch (opt) {
+            case 'f':
+                if (strcmp(optarg, "json") == 0) json = true;
+                else if (strcmp(optarg, "csv") == 0) json = false;
+                else {
+                    print_usage(argv[0]);
+                    return 1;
+                }
+                break;
+            case 's': shares_only = true; break;
+            case 'h': print_usage(argv[0]); return 0;
+            default:
+                print_usage(argv[0]);
+                return 1;
+        }
+    }
+    if (optind >= argc) {
+        print_usage(argv[0]);
+        return 1;
+    }
+
+    if (!json) {
+        printf("time,type,thread,pool,difficulty,nonce,solve_ms,job_rtt_ms,submit_rtt_ms,"
+               "verdict,reason\n");
+    }
+    bool ok = true;
+    for (int i = optind; i < argc; i++) {
+        ok = dump_file(argv[i], json, shares_only) && ok;
+    }
+    return ok ? 0 : 1;
+}
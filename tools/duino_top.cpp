@@ -0,0 +1,166 @@
+// Live view of a running miner from its shared-memory stats segment.
+// Reads only: no sockets, no parsing, and the miner is never blocked.
+#include "../include/shm_stats.h"
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <getopt.h>
+#include <csignal>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <thread>
+#include <chrono>
+
+static volatile sig_atomic_t stop = 0;
+
+static const char* tier_names[] = {"LOW", "MEDIUM", "NET"};
+static const char* phase_names[] = {
+    "connect", "job", "decode", "hash", "submit", "log", "throttle", "paused"
+};
+
+struct Segment {
+    const char* base = nullptr;
+    size_t size = 0;
+};
+
+static void print_usage(const char* program_name) {
+    printf("Usage: %s [OPTIONS]\n\n", program_name);
+    printf("Options:\n");
+    printf("  -s, --shm <name>            Segment name (default: /duino-cpu)\n");
+    printf("  -i, --interval <ms>         Refresh interval (default: 1000)\n");
+    printf("  -n, --once                  Print one snapshot and exit\n");
+    printf("  -h, --help                  Show this help message\n\n");
+}
+
+static bool open_segment(const std::string& name, Segment& seg) {
+    int fd = shm_open(name.c_str(), O_RDONLY, 0);
+    if (fd < 0) return false;
+    struct stat st;
+    if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(ShmStatsHeader)) {
+        close(fd);
+        return false;
+    }
+    void* p = mmap(nullptr, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (p == MAP_FAILED) return false;
+    seg.base = (const char*)p;
+    seg.size = st.st_size;
+    return true;
+}
+
+// Seqlock read of the whole segment into buffer
+static bool read_segment(const Segment& seg, std::vector<char>& buffer) {
+    const ShmStatsHeader* header = (const ShmStatsHeader*)seg.base;
+    if (header->magic != SHM_STATS_MAGIC || header->version < 1) return false;
+
+    buffer.resize(seg.size);
+    for (int attempt = 0; attempt < 1000; attempt++) {
+        uint64_t before = header->seq.load(std::memory_order_acquire);
+        if (before & 1) {
+            std::this_thread::yield();
+            continue;
+        }
+        memcpy(buffer.data(), seg.base, seg.size);
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (header->seq.load(std::memory_order_relaxed) == before) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static std::string format_hashrate(double h) {
+    char buf[32];
+    if (h >= 1e6) snprintf(buf, sizeof(buf), "%.2f MH/s", h / 1e6);
+    else if (h >= 1e3) snprintf(buf, sizeof(buf), "%.1f kH/s", h / 1e3);
+    else snprintf(buf, sizeof(buf), "%.0f H/s", h);
+    return buf;
+}
+
+static void render(const std::vector<char>& buffer, bool clear) {
+    const ShmStatsHeader* h = (const ShmStatsHeader*)buffer.data();
+    if (clear) printf("\033[H\033[2J");
+
+    uint64_t up = h->uptime_ns / 1000000000ULL;
+    printf("duino-cpu %s  pid %d  rig %s  kernel %s  up %lluh%02llum%02llus%s\n",
+           h->version_string, h->pid, h->rig, h->kernel,
+           (unsigned long long)(up / 3600), (unsigned long long)(up / 60 % 60),
+           (unsigned long long)(up % 60), h->paused ? "  [PAUSED]" : "");
+    printf("speed 10s/60s/15m %s %s %s  max %s\n",
+           format_hashrate(h->hashrate_10s).c_str(), format_hashrate(h->hashrate_60s).c_str(),
+           format_hashrate(h->hashrate_15m).c_str(), format_hashrate(h->hashrate_max).c_str());
+    printf("shares %llu accepted / %llu rejected / %llu blocks\n\n",
+           (unsigned long long)h->accepted, (unsigned long long)h->rejected,
+           (unsigned long long)h->blocks);
+
+    printf("%-5s %12s %12s %-7s %-9s %5s %8s %15s %15s %9s\n", "T", "10s", "60s", "diff",
+           "state", "pool", "jobs", "job p50/p99", "submit p50/p99", "solve p50");
+    const char* rows = buffer.data() + h->header_size;
+    for (uint32_t i = 0; i < h->thread_count; i++) {
+        if (h->header_size + (i + 1) * (size_t)h->thread_stride > buffer.size()) break;
+        const ShmThreadStats* t = (const ShmThreadStats*)(rows + i * (size_t)h->thread_stride);
+        char job[32], submit[32];
+        snprintf(job, sizeof(job), "%.1f/%.1fms", t->job_rtt_p50_ms, t->job_rtt_p99_ms);
+        snprintf(submit, sizeof(submit), "%.1f/%.1fms", t->submit_rtt_p50_ms,
+                 t->submit_rtt_p99_ms);
+        printf("%-5u %12s %12s %-7s %-9s %5d %8llu %15s %15s %8.2fs\n", i,
+               format_hashrate(t->hashrate_10s).c_str(),
+               format_hashrate(t->hashrate_60s).c_str(),
+               t->tier >= 0 && t->tier < 3 ? tier_names[t->tier] : "?",
+               t->phase >= 0 && t->phase < 8 ? phase_names[t->phase] : "?",
+               t->pool, (unsigned long long)t->jobs, job, submit, t->solve_p50_ms / 1000.0);
+    }
+    fflush(stdout);
+}
+
+int main(int argc, char* argv[]) {
+    static struct option long_options[] = {
+        {"shm", required_argument, 0, 's'},
+        {"interval", required_argument, 0, 'i'},
+        {"once", no_argument, 0, 'n'},
+        {"help", no_argument, 0, 'h'},
+        {0, 0, 0, 0}
+    };
+
+    std::string name = "/duino-cpu";
+    int interval_ms = 1000;
+    bool once = false;
+
+    int opt;
+    while ((opt = getopt_long(argc, argv, "s:i:nh", long_options, nullptr)) != -1) {
+        switch (opt) {
+            case 's': name = optarg[0] == '/' ? optarg : std::string("/") + optarg; break;
+            case 'i': interval_ms = std::max(10, atoi(optarg)); break;
+            case 'n': once = true; break;
+            case 'h': print_usage(argv[0]); return 0;
+            default:
+                print_usage(argv[0]);
+                return 1;
+        }
+    }
+
+    signal(SIGINT, [](int) { stop = 1; });
+    signal(SIGTERM, [](int) { stop = 1; });
+
+    Segment seg;
+    if (!open_segment(name, seg)) {
+        fprintf(stderr, "Cannot open shared memory %s (is the miner running with shm_name?)\n",
+                name.c_str());
+        return 1;
+    }
+
+    std::vector<char> buffer;
+    while (!stop) {
+        if (!read_segment(seg, buffer)) {
+            fprintf(stderr, "Segment %s is not a duino-cpu stats segment\n", name.c_str());
+            return 1;
+        }
+        render(buffer, !once);
+        if (once) break;
+        std::this_thread::sleep_for(std::chrono::milliseconds(interval_ms));
+    }
+    return 0;
+}
@@ -0,0 +1,521 @@
+// Local stand-in for a DUCO pool node, plus an end-to-end load harness.
+// Speaks the same line protocol as the real pool: version banner,
+// JOB,user,diff,key -> last_hash,expected,diff and share -> GOOD/BAD/BLOCK.
+#include "../include/hasher.h"
+#include "../include/logger.h"
+#include "../include/share_journal.h"
+#include <openssl/sha.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <arpa/inet.h>
+#include <unistd.h>
+#include <csignal>
+#include <getopt.h>
+#include <poll.h>
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <iomanip>
+#include <mutex>
+#include <random>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include <algorithm>
+#include <cstring>
+
+#define POOL_VERSION "3.0"
+
+struct MockOptions {
+    int port = 2813;
+    int diff = 100;             // NET tier; LOW = diff/25, MEDIUM = diff/5
+    int latency_ms = 0;         // added before every reply
+    int jitter_ms = 0;          // uniform +/- on top of latency
+    bool fragment = false;      // split replies into small TCP segments
+    int gap_ms = 0;             // pause between fragments, 0 = random 1-3 ms
+    double disconnect_rate = 0; // chance of dropping the session after a share
+    double reject_rate = 0;     // chance of answering BAD to a valid share
+    double block_rate = 0;      // chance of answering BLOCK to a valid share
+    std::string record_file;
+    std::string replay_file;
+    int duration = 0;           // seconds, 0 = until interrupted
+    std::string harness;        // miner binary to run against the pool
+    int harness_threads = 0;
+    std::vector<std::string> harness_args;
+};
+
+struct MockJob {
+    std::string last_hash;
+    std::string expected;
+    int diff;
+    unsigned long nonce;
+};
+
+struct MockStats {
+    std::atomic<unsigned long> connections{0};
+    std::atomic<unsigned long> jobs{0};
+    std::atomic<unsigned long> good{0};
+    std::atomic<unsigned long> bad{0};
+    std::atomic<unsigned long> blocks{0};
+    std::atomic<unsigned long> dropped{0};
+    std::mutex mutex;
+    std::vector<double> solve_ms;      // job sent -> share received
+    std::vector<double> reconnect_ms;  // injected drop -> next connection
+    std::chrono::steady_clock::time_point last_drop;
+    bool drop_pending = false;
+};
+
+static MockOptions opts;
+static MockStats stats;
+static std::atomic<bool> running(true);
+static std::mutex record_mutex;
+static std::ofstream record_out;
+static std::vector<MockJob> replay_jobs;
+static std::string harness_journal;    // written by the --harness miner
+static std::atomic<size_t> replay_index{0};
+
+static void signal_handler(int) {
+    running = false;
+}
+
+static double ms_since(std::chrono::steady_clock::time_point t) {
+    return std::chrono::duration<double, std::milli>(
+        std::chrono::steady_clock::now() - t).count();
+}
+
+static MockJob make_job(const std::string& tier, std::mt19937_64& rng) {
+    if (!replay_jobs.empty()) {
+        return replay_jobs[replay_index++ % replay_jobs.size()];
+    }
+
+    int diff = opts.diff;
+    if (tier == "LOW") diff = std::max(1, opts.diff / 25);
+    else if (tier == "MEDIUM") diff = std::max(1, opts.diff / 5);
+
+    uint8_t seed[20];
+    for (auto& b : seed) b = rng() & 0xFF;
+
+    MockJob job;
+    job.last_hash = Hasher::bytes_to_hex(seed, 20);
+    job.diff = diff;
+    job.nonce = rng() % (diff * 100UL);
+
+    std::string input = job.last_hash + std::to_string(job.nonce);
+    uint8_t digest[20];
+    SHA1((const unsigned char*)input.c_str(), input.length(), digest);
+    job.expected = Hasher::bytes_to_hex(digest, 20);
+
+    if (record_out.is_open()) {
+        std::lock_guard<std::mutex> lock(record_mutex);
+        record_out << job.last_hash << "," << job.expected << ","
+                   << job.diff << "," << job.nonce << "\n";
+    }
+    return job;
+}
+
+static bool load_replay(const std::string& file) {
+    std::ifstream in(file);
+    if (!in) return false;
+
+    std::string line;
+    while (std::getline(in, line)) {
+        std::stringstream ss(line);
+        std::string diff, nonce;
+        MockJob job;
+        if (std::getline(ss, job.last_hash, ',') && std::getline(ss, job.expected, ',') &&
+            std::getline(ss, diff, ',') && std::getline(ss, nonce)) {
+            job.diff = std::stoi(diff);
+            job.nonce = std::stoul(nonce);
+            replay_jobs.push_back(job);
+        }
+    }
+    return !replay_jobs.empty();
+}
+
+static bool send_reply(int fd, const std::string& msg, std::mt19937_64& rng) {
+    int delay = opts.latency_ms;
+    if (opts.jitter_ms > 0) {
+        delay += (int)(rng() % (2 * opts.jitter_ms + 1)) - opts.jitter_ms;
+    }
+    if (delay > 0) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(delay));
+    }
+
+    size_t sent = 0;
+    while (sent < msg.length()) {
+        size_t chunk = msg.length() - sent;
+        if (opts.fragment) {
+            chunk = std::min<size_t>(chunk, 1 + rng() % 7);
+        }
+        ssize_t n = ::send(fd, msg.c_str() + sent, chunk, MSG_NOSIGNAL);
+        if (n <= 0) return false;
+        sent += n;
+        if (opts.fragment && sent < msg.length()) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(
+                opts.gap_ms > 0 ? opts.gap_ms : 1 + (int)(rng() % 3)));
+        }
+    }
+    return true;
+}
+
+static void handle_client(int fd) {
+    std::mt19937_64 rng(std::random_device{}() ^ (uint64_t)fd);
+    std::uniform_real_distribution<double> chance(0.0, 1.0);
+
+    int flag = 1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &flag, sizeof(flag));
+
+    // Version banner is sent without a newline, like the real pool
+    send_reply(fd, POOL_VERSION, rng);
+
+    std::string buffer;
+    MockJob job;
+    bool have_job = false;
+    auto job_sent = std::chrono::steady_clock::now();
+
+    while (running) {
+        struct pollfd pfd;
+        pfd.fd = fd;
+        pfd.events = POLLIN;
+        if (poll(&pfd, 1, 200) <= 0) continue;
+
+        char chunk[4096];
+        ssize_t n = recv(fd, chunk, sizeof(chunk), 0);
+        if (n <= 0) break;
+        buffer.append(chunk, n);
+
+        size_t newline;
+        bool drop = false;
+        while ((newline = buffer.find('\n')) != std::string::npos) {
+            std::string line = buffer.substr(0, newline);
+            buffer.erase(0, newline + 1);
+
+            if (line.compare(0, 4, "JOB,") == 0) {
+                // JOB,username,diff,key
+                std::stringstream ss(line);
+                std::string cmd, user, tier;
+                std::getline(ss, cmd, ',');
+                std::getline(ss, user, ',');
+                std::getline(ss, tier, ',');
+
+                job = make_job(tier, rng);
+                have_job = true;
+                stats.jobs++;
+                if (!send_reply(fd, job.last_hash + "," + job.expected + "," +
+                                std::to_string(job.diff) + "\n", rng)) {
+                    drop = true;
+                    break;
+                }
+                job_sent = std::chrono::steady_clock::now();
+                continue;
+            }
+
+            // nonce,hashrate,software,rig,,miner_id
+            double solve = ms_since(job_sent);
+            unsigned long nonce = strtoul(line.c_str(), nullptr, 10);
+
+            std::string verdict;
+            if (!have_job || nonce != job.nonce) {
+                verdict = "BAD,Incorrect result";
+                stats.bad++;
+            } else if (chance(rng) < opts.reject_rate) {
+                verdict = "BAD,Rejected by mock pool";
+                stats.bad++;
+            } else if (chance(rng) < opts.block_rate) {
+                verdict = "BLOCK";
+                stats.blocks++;
+                stats.good++;
+            } else {
+                verdict = "GOOD";
+                stats.good++;
+            }
+            have_job = false;
+
+            if (!send_reply(fd, verdict + "\n", rng)) {
+                drop = true;
+                break;
+            }
+
+            {
+                std::lock_guard<std::mutex> lock(stats.mutex);
+                stats.solve_ms.push_back(solve);
+            }
+
+            if (chance(rng) < opts.disconnect_rate) {
+                stats.dropped++;
+                std::lock_guard<std::mutex> lock(stats.mutex);
+                stats.last_drop = std::chrono::steady_clock::now();
+                stats.drop_pending = true;
+                drop = true;
+                break;
+            }
+        }
+        if (drop) break;
+    }
+
+    shutdown(fd, SHUT_RDWR);
+    close(fd);
+}
+
+static double percentile(std::vector<double> values, double p) {
+    if (values.empty()) return 0.0;
+    std::sort(values.begin(), values.end());
+    size_t idx = std::min(values.size() - 1, (size_t)(p / 100.0 * values.size()));
+    return values[idx];
+}
+
+// Round trips as the miner saw them, from the journal of a --harness run:
+// everything between its socket calls, injected delays and gaps included
+struct ClientTimes {
+    std::vector<double> job_ms;        // JOB request -> job line parsed
+    std::vector<double> verdict_ms;    // share sent -> verdict line parsed
+    unsigned long lost = 0;            // no verdict, the session was dropped
+    bool loaded = false;
+};
+
+static ClientTimes read_client_times(const std::string& file) {
+    ClientTimes times;
+    FILE* f = fopen(file.c_str(), "rb");
+    if (!f) return times;
+    JournalFileHeader header;
+    if (fread(&header, sizeof(header), 1, f) == 1 &&
+        memcmp(header.magic, JOURNAL_MAGIC, sizeof(header.magic)) == 0 &&
+        header.record_size == sizeof(JournalRecord)) {
+        times.loaded = true;
+        JournalRecord r;
+        while (fread(&r, sizeof(r), 1, f) == 1) {
+            if (r.type == JOURNAL_JOB) {
+                times.job_ms.push_back(r.job_rtt_us / 1000.0);
+            } else if (r.type == JOURNAL_SHARE && r.verdict == JOURNAL_LOST) {
+                times.lost++;
+            } else if (r.type == JOURNAL_SHARE) {
+                times.verdict_ms.push_back(r.submit_rtt_us / 1000.0);
+            }
+        }
+    }
+    fclose(f);
+    return times;
+}
+
+static void print_report(double seconds, const ClientTimes& client) {
+    std::lock_guard<std::mutex> lock(stats.mutex);
+    unsigned long shares = stats.good + stats.bad;
+
+    std::cout << "\n================ MOCK POOL REPORT ================\n";
+    std::cout << std::fixed << std::setprecision(2);
+    std::cout << "Duration:        " << seconds << " s\n";
+    std::cout << "Connections:     " << stats.connections
+              << " (" << stats.dropped << " dropped by pool)\n";
+    std::cout << "Jobs served:     " << stats.jobs << "\n";
+    std::cout << "Shares:          " << stats.good << " good / " << stats.bad
+              << " bad / " << stats.blocks << " blocks\n";
+    std::cout << "Shares/s:        " << (seconds > 0 ? shares / seconds : 0.0) << "\n";
+
+    auto print_latency = [](const char* name, const std::vector<double>& v) {
+        std::cout << name << "p50 " << percentile(v, 50) << " ms, p90 "
+                  << percentile(v, 90) << " ms, p99 " << percentile(v, 99)
+                  << " ms (" << v.size() << " samples)\n";
+    };
+    print_latency("Job->share:      ", stats.solve_ms);
+    if (client.loaded) {
+        print_latency("Job RTT:         ", client.job_ms);
+        print_latency("Verdict latency: ", client.verdict_ms);
+        std::cout << "Lost verdicts:   " << client.lost << "\n";
+    } else {
+        std::cout << "Verdict latency: measured by the miner, run with --harness\n";
+    }
+    print_latency("Reconnect gap:   ", stats.reconnect_ms);
+    std::cout << "==================================================\n";
+}
+
+static pid_t start_harness() {
+    pid_t pid = fork();
+    if (pid != 0) return pid;
+
+    std::vector<std::string> args = {
+        opts.harness, "-u", "mockpool", "-p", "127.0.0.1:" + std::to_string(opts.port)
+    };
+    if (opts.harness_threads > 0) {
+        args.push_back("-t");
+        args.push_back(std::to_string(opts.harness_threads));
+    }
+    // Client-side round trips for the report
+    args.push_back("--journal");
+    args.push_back(harness_journal);
+    args.insert(args.end(), opts.harness_args.begin(), opts.harness_args.end());
+
+    std::vector<char*> argv;
+    for (auto& a : args) argv.push_back(&a[0]);
+    argv.push_back(nullptr);
+
+    execv(argv[0], argv.data());
+    perror("execv");
+    _exit(127);
+}
+
+static void print_usage(const char* program_name) {
+    std::cout << "Usage: " << program_name << " [OPTIONS] [-- miner args]\n\n";
+    std::cout << "Options:\n";
+    std::cout << "  -P, --port <port>           Listen port (default: 2813)\n";
+    std::cout << "  -d, --diff <n>              NET difficulty; LOW/MEDIUM are 1/25, 1/5 (default: 100)\n";
+    std::cout << "  -l, --latency <ms>          Delay before every reply\n";
+    std::cout << "  -j, --jitter <ms>           Random +/- latency\n";
+    std::cout << "  -f, --fragment              Send replies in small fragments\n";
+    std::cout << "  -g, --gap <ms>              Pause between fragments (implies -f, default: 1-3)\n";
+    std::cout << "  -D, --disconnect <0-1>      Chance to drop the session after a share\n";
+    std::cout << "  -R, --reject <0-1>          Chance to reject a valid share\n";
+    std::cout << "  -B, --block <0-1>           Chance to answer BLOCK to a valid share\n";
+    std::cout << "  -w, --record <file>         Record served jobs\n";
+    std::cout << "  -r, --replay <file>         Serve recorded jobs instead of random ones\n";
+    std::cout << "  -T, --duration <s>          Stop after s seconds and print the report\n";
+    std::cout << "  -x, --harness <duino-cpu>   Run the miner against this pool\n";
+    std::cout << "  -t, --threads <n>           Miner threads for --harness\n";
+    std::cout << "  -h, --help                  Show this help message\n\n";
+}
+
+int main(int argc, char* argv[]) {
+    static struct option long_options[] = {
+        {"port", required_argument, 0, 'P'},
+        {"diff", required_argument, 0, 'd'},
+        {"latency", required_argument, 0, 'l'},
+        {"jitter", required_argument, 0, 'j'},
+        {"fragment", no_argument, 0, 'f'},
+        {"gap", required_argument, 0, 'g'},
+        {"disconnect", required_argument, 0, 'D'},
+        {"reject", required_argument, 0, 'R'},
+        {"block", required_argument, 0, 'B'},
+        {"record", required_argument, 0, 'w'},
+        {"replay", required_argument, 0, 'r'},
+        {"duration", required_argument, 0, 'T'},
+        {"harness", required_argument, 0, 'x'},
+        {"threads", required_argument, 0, 't'},
+        {"help", no_argument, 0, 'h'},
+        {0, 0, 0, 0}
+    };
+
+    int opt;
+    while ((opt = getopt_long(argc, argv, "P:d:l:j:fg:D:R:B:w:r:T:x:t:h", long_options, nullptr)) != -1) {
+        switch (opt) {
+            case 'P': opts.port = std::stoi(optarg); break;
+            case 'd': opts.diff = std::max(1, std::stoi(optarg)); break;
+            case 'l': opts.latency_ms = std::stoi(optarg); break;
+            case 'j': opts.jitter_ms = std::stoi(optarg); break;
+            case 'f': opts.fragment = true; break;
+            case 'g':
+                opts.gap_ms = std::max(0, std::stoi(optarg));
+                opts.fragment = true;
+                break;
+            case 'D': opts.disconnect_rate = std::stod(optarg); break;
+            case 'R': opts.reject_rate = std::stod(optarg); break;
+            case 'B': opts.block_rate = std::stod(optarg); break;
+            case 'w': opts.record_file = optarg; break;
+            case 'r': opts.replay_file = optarg; break;
+            case 'T': opts.duration = std::stoi(optarg); break;
+            case 'x': opts.harness = optarg; break;
+            case 't': opts.harness_threads = std::stoi(optarg); break;
+            case 'h': print_usage(argv[0]); return 0;
+            default:
+                print_usage(argv[0]);
+                return 1;
+        }
+    }
+    for (int i = optind; i < argc; i++) {
+        opts.harness_args.push_back(argv[i]);
+    }
+
+    if (!opts.replay_file.empty() && !load_replay(opts.replay_file)) {
+        Logger::error("Failed to load replay file: " + opts.replay_file);
+        return 1;
+    }
+    if (!opts.record_file.empty()) {
+        record_out.open(opts.record_file, std::ios::app);
+        if (!record_out) {
+            Logger::error("Failed to open record file: " + opts.record_file);
+            return 1;
+        }
+    }
+
+    int listen_fd = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    int reuse = 1;
+    setsockopt(listen_fd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    addr.sin_port = htons(opts.port);
+
+    if (bind(listen_fd, (struct sockaddr*)&addr, sizeof(addr)) != 0 ||
+        listen(listen_fd, 1024) != 0) {
+        Logger::error("Failed to listen on port " + std::to_string(opts.port));
+        return 1;
+    }
+
+    std::signal(SIGINT, signal_handler);
+    std::signal(SIGTERM, signal_handler);
+
+    Logger::info("Mock pool listening on 127.0.0.1:" + std::to_string(opts.port));
+
+    pid_t miner_pid = -1;
+    if (!opts.harness.empty()) {
+        harness_journal = "/tmp/duino-mockpool-" + std::to_string(getpid()) + ".journal";
+        miner_pid = start_harness();
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> clients;
+
+    while (running) {
+        if (opts.duration > 0 && ms_since(start) >= opts.duration * 1000.0) {
+            break;
+        }
+        if (miner_pid > 0 && waitpid(miner_pid, nullptr, WNOHANG) == miner_pid) {
+            Logger::warning("Miner exited early");
+            miner_pid = -1;
+            break;
+        }
+
+        struct pollfd pfd;
+        pfd.fd = listen_fd;
+        pfd.events = POLLIN;
+        if (poll(&pfd, 1, 200) <= 0) continue;
+
+        int fd = accept4(listen_fd, nullptr, nullptr, SOCK_CLOEXEC);
+        if (fd < 0) continue;
+
+        stats.connections++;
+        {
+            std::lock_guard<std::mutex> lock(stats.mutex);
+            if (stats.drop_pending) {
+                stats.reconnect_ms.push_back(ms_since(stats.last_drop));
+                stats.drop_pending = false;
+            }
+        }
+        clients.emplace_back(handle_client, fd);
+    }
+
+    double elapsed = ms_since(start) / 1000.0;
+    running = false;
+
+    if (miner_pid > 0) {
+        kill(miner_pid, SIGINT);
+        waitpid(miner_pid, nullptr, 0);
+    }
+
+    close(listen_fd);
+    for (auto& t : clients) {
+        t.join();
+    }
+
+    ClientTimes client;
+    if (!opts.harness.empty()) {
+        client = read_client_times(harness_journal);
+        unlink(harness_journal.c_str());
+    }
+    print_report(elapsed, client);
+    return 0;
+}